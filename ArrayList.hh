@@ -12,8 +12,12 @@ use Titon\Common\Jsonable;
 use Titon\Common\Mapable;
 use Titon\Common\Vectorable;
 use Titon\Common\Xmlable;
+use Titon\Type\Exception\InvalidBinaryException;
 use Titon\Type\Exception\MissingMethodException;
+use Titon\Type\Json\Writer as JsonWriter;
+use Titon\Type\Sink\BufferSink;
 use Titon\Type\Xml;
+use Titon\Type\Xml\Writer as XmlWriter;
 use Titon\Utility\Col;
 use \ArrayAccess;
 use \Countable;
@@ -27,17 +31,12 @@ use \Indexish;
  * integration with built-in Vector methods through PHP magic methods, and a easily fluent chainable API.
  *
  * @package Titon\Type
- * @method $this add(Tv $value)
  * @method $this addAll(Traversable<Tv> $values)
  * @method $this clear()
- * @method ArrayList filter((function(Tv): bool) $callback)
- * @method ArrayList filterWithKey((function(int, Tv): bool) $callback)
- * @method ArrayList map((function(Tv): bool) $callback)
- * @method ArrayList mapWithKey((function(int, Tv): bool) $callback)
+ * @method $this removeKey(int $index)
  * @method $this reserve(int $size)
  * @method $this resize(int $size, Tv $value)
  * @method ArrayList reverse()
- * @method $this set(int $index, Tv $value)
  * @method $this setAll(KeyedTraversable<int, Tv> $values)
  * @method ArrayList shuffle()
  * @method ArrayList splice(int $offset, int $length)
@@ -55,24 +54,32 @@ class ArrayList<Tv> implements
 
     /**
      * Methods on the Vector collection that should be chainable through ArrayList.
+     * Frequently used methods (add, set) are defined directly and do not use magic dispatch.
      *
-     * @var Vector<string>
+     * @var ImmSet<string>
      */
-    protected Vector<string> $chainable = Vector {
-        'add', 'addAll', 'clear', 'removeKey',
-        'reserve', 'resize', 'set', 'setAll'
+    protected static ImmSet<string> $chainable = ImmSet {
+        'addAll', 'clear', 'removeKey',
+        'reserve', 'resize', 'setAll'
     };
 
     /**
      * Methods on the Vector collection that should return a new ArrayList instance.
+     * Frequently used methods (filter, map, etc) are defined directly and do not use magic dispatch.
      *
-     * @var Vector<string>
+     * @var ImmSet<string>
      */
-    protected Vector<string> $immutable = Vector {
-        'filter', 'filterWithKey', 'map', 'mapWithKey',
+    protected static ImmSet<string> $immutable = ImmSet {
         'reverse', 'shuffle', 'splice'
     };
 
+    /**
+     * Tracks how many lists share the internal Vector.
+     *
+     * @var \Titon\Type\RefCount
+     */
+    protected RefCount $refs;
+
     /**
      * Raw internal Vector used for list management.
      *
@@ -80,17 +87,34 @@ class ArrayList<Tv> implements
      */
     protected Vector<Tv> $value = Vector {};
 
+    /**
+     * Lazily built mapping of hashable values to the first index they appear at.
+     * Only used when value indexing has been enabled.
+     *
+     * @var Map<arraykey, int>
+     */
+    protected ?Map<arraykey, int> $valueIndex = null;
+
+    /**
+     * Whether value lookups should use the value index.
+     *
+     * @var bool
+     */
+    protected bool $valueIndexed = false;
+
     /**
      * Set the value.
      *
      * @param Indexish<int, Tv> $value
      */
     final public function __construct(Indexish<int, Tv> $value = Vector {}) {
+        $this->refs = new RefCount();
         $this->write($value);
     }
 
     /**
      * Allow methods on the base Vector class to be called programmatically.
+     * Only methods defined in the `$chainable` and `$immutable` tables can be called.
      *
      * @param string $method
      * @param array<mixed> $args
@@ -98,46 +122,73 @@ class ArrayList<Tv> implements
      * @throws \Titon\Type\Exception\MissingMethodException
      */
     public function __call(string $method, array<mixed> $args): ArrayList<Tv> {
-        $vector = $this->value();
 
-        if (method_exists($vector, $method)) {
+        // Chain the method call
+        if (static::$chainable->contains($method)) {
 
-            // Chain the method call
-            if (in_array($method, $this->chainable)) {
+            // Copy the vector first if it is shared with other lists
+            $vector = $this->detach();
 
-                // UNSAFE
-                // Since `inst_meth()` requires literal strings and we are passing variables
-                call_user_func_array(inst_meth($vector, $method), $args);
+            // UNSAFE
+            // Since `inst_meth()` requires literal strings and we are passing variables
+            call_user_func_array(inst_meth($vector, $method), $args);
 
-                return $this;
+            $this->invalidate();
 
-            // Return a new instance for immutability
-            } else if (in_array($method, $this->immutable)) {
+            return $this;
 
-                // Clone the vector so we don't interfere with references
-                $clonedList = $vector->toVector();
+        // Return a new instance for immutability
+        } else if (static::$immutable->contains($method)) {
 
-                // UNSAFE
-                // Since `inst_meth()` requires literal strings and we are passing variables
-                $mutatedList = call_user_func_array(inst_meth($clonedList, $method), $args);
+            // Clone the vector so we don't interfere with references
+            $clonedList = $this->toVector();
 
-                // Some methods return void/null (reverse, etc) so use the cloned list
-                if ($mutatedList === null) {
-                    $mutatedList = $clonedList;
-                }
+            // UNSAFE
+            // Since `inst_meth()` requires literal strings and we are passing variables
+            $mutatedList = call_user_func_array(inst_meth($clonedList, $method), $args);
 
-                return new static($mutatedList);
+            // Some methods return void/null (reverse, etc) so use the cloned list
+            if ($mutatedList === null) {
+                $mutatedList = $clonedList;
             }
+
+            return $this->wrap($mutatedList);
         }
 
         throw new MissingMethodException(sprintf('Method "%s" does not exist or is not callable for %s', $method, static::class));
     }
 
     /**
-     * Clone the internal vector so references aren't shared.
+     * Share the internal vector with the clone. The vector will be copied once either list is modified.
      */
     public function __clone(): void {
-        $this->value = $this->value->toVector();
+        $this->refs->acquire();
+
+        // Indexes are updated in place so they can't be shared
+        $this->invalidate();
+    }
+
+    /**
+     * Release the internal vector once the list is no longer used, so that other wrappers sharing it can modify it without copying.
+     */
+    public function __destruct(): void {
+        $this->refs->release();
+    }
+
+    /**
+     * Alias for Vector::add(). Add a value to the end of the list.
+     *
+     * @param Tv $value
+     * @return $this
+     */
+    public function add(Tv $value): this {
+        $vector = $this->detach();
+
+        $this->appendIndex($value);
+
+        $vector->add($value);
+
+        return $this;
     }
 
     /**
@@ -157,24 +208,70 @@ class ArrayList<Tv> implements
      * @return Tv
      */
     public function at(int $index): Tv {
-        return $this->value()->at($index);
+        return $this->value->at($index);
+    }
+
+    /**
+     * Return the average of all values in the list, or 0 if the list is empty.
+     * The values are expected to be numeric.
+     *
+     * @return float
+     */
+    public function average(): float {
+        $count = $this->count();
+
+        if ($count === 0) {
+            return 0.0;
+        }
+
+        return (float) $this->sum() / $count;
+    }
+
+    /**
+     * Return the last K items that a sort with the callback would produce, in sorted order.
+     * Uses a bounded heap, so only K items are held and sorted, at O(n log k).
+     *
+     * @param int $k
+     * @param (function(Tv, Tv): int) $callback
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    public function bottomK(int $k, ?(function(Tv, Tv): int) $callback = null): ArrayList<Tv> {
+        $callback = $callback ?: Heap::natural();
+        $list = $this->select($k, ($a, $b) ==> $callback($b, $a));
+        $list->reverse();
+
+        return $this->wrap($list);
     }
 
     /**
-     * Split a list into multiple chunked lists.
+     * Split a list into multiple chunks. Each chunk is a read-only slice view over the list,
+     * so values are not copied until a chunk is converted.
      *
      * @param int $size
-     * @return \Titon\Type\ArrayList<ArrayList<Tv>>
+     * @return \Titon\Type\ArrayList<ListSlice<Tv>>
      */
-    public function chunk(int $size): ArrayList<ArrayList<Tv>> {
-        $chunks = array_chunk($this->toArray(), $size);
+    public function chunk(int $size): ArrayList<ListSlice<Tv>> {
         $list = Vector {};
 
-        foreach ($chunks as $chunk) {
-            $list[] = new static($chunk);
+        foreach ($this->chunks($size) as $chunk) {
+            $list[] = $chunk;
         }
 
-        return new static($list);
+        return (new ArrayList())->adopt($list);
+    }
+
+    /**
+     * Return a generator that yields one chunk (a read-only slice view) at a time.
+     *
+     * @param int $size
+     * @return Iterator<\Titon\Type\ListSlice<Tv>>
+     */
+    public function chunks(int $size): Iterator<ListSlice<Tv>> {
+        invariant($size > 0, 'Chunk size must be greater than 0');
+
+        for ($offset = 0, $count = $this->count(); $offset < $count; $offset += $size) {
+            yield $this->slice($offset, $size);
+        }
     }
 
     /**
@@ -195,16 +292,17 @@ class ArrayList<Tv> implements
      * @return \Titon\Type\ArrayList<Tv>
      */
     public function concat(ArrayList<Tv> $value, bool $append = true): ArrayList<Tv> {
-        $oldList = $this->toVector();
-        $newList = $value->toVector();
+        if ($value->isEmpty()) {
+            return clone $this;
+        }
 
         if ($append) {
-            $list = $oldList->addAll($newList);
+            $list = $this->toVector()->addAll($value->value);
         } else {
-            $list = $newList->addAll($oldList);
+            $list = $value->toVector()->addAll($this->value);
         }
 
-        return new static($list);
+        return $this->wrap($list);
     }
 
     /**
@@ -214,7 +312,11 @@ class ArrayList<Tv> implements
      * @return bool
      */
     public function contains(Tv $value): bool {
-        return in_array($value, $this->value(), true);
+        if ($this->valueIndexed && (is_int($value) || is_string($value))) {
+            return $this->valueIndex()->containsKey($value);
+        }
+
+        return in_array($value, $this->value, true);
     }
 
     /**
@@ -223,7 +325,24 @@ class ArrayList<Tv> implements
      * @return int
      */
     public function count(): int {
-        return $this->value()->count();
+        return $this->value->count();
+    }
+
+    /**
+     * Count how many values return the same key from the callback, in a single pass.
+     *
+     * @param (function(Tv): Tu) $callback
+     * @return \Titon\Type\HashMap<Tu, int>
+     */
+    public function countBy<Tu>((function(Tv): Tu) $callback): HashMap<Tu, int> {
+        $counts = Map {};
+
+        foreach ($this->value as $value) {
+            $key = $callback($value);
+            $counts[$key] = $counts->contains($key) ? $counts[$key] + 1 : 1;
+        }
+
+        return (new HashMap())->adopt($counts);
     }
 
     /**
@@ -234,7 +353,22 @@ class ArrayList<Tv> implements
      * @return int
      */
     public function depth(): int {
-        return Col::depth($this->value());
+        return Col::depth($this->value);
+    }
+
+    /**
+     * Return the values whose key from the callback is not returned by the other callback for any value
+     * of the other traversable. The other keys are hashed once, so the difference is a single pass over each side.
+     *
+     * @param Traversable<Tr> $other
+     * @param (function(Tv): arraykey) $key
+     * @param (function(Tr): arraykey) $otherKey
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    public function diffByKey<Tr>(Traversable<Tr> $other, (function(Tv): arraykey) $key, (function(Tr): arraykey) $otherKey): ArrayList<Tv> {
+        $keys = Join::keys($other, $otherKey);
+
+        return $this->filter($value ==> !$keys->contains($key($value)));
     }
 
     /**
@@ -247,7 +381,14 @@ class ArrayList<Tv> implements
      * @return \Titon\Type\ArrayList<Tv>
      */
     public function each((function(int, Tv): Tv) $callback): ArrayList<Tv> {
-        return new static(Col::each($this->value(), $callback));
+        $start = Profiler::$enabled ? microtime(true) : 0.0;
+        $value = Col::each($this->value, $callback);
+
+        if ($start > 0.0) {
+            Profiler::record(static::class, __FUNCTION__, $this->count(), 0, $this->count(), $start);
+        }
+
+        return new static($value);
     }
 
     /**
@@ -257,15 +398,19 @@ class ArrayList<Tv> implements
      * @return $this
      */
     public function erase(Tv $erase): ArrayList<Tv> {
+        if ($this->valueIndexed && !$this->contains($erase)) {
+            return clone $this;
+        }
+
         $list = Vector {};
 
-        foreach ($this->value() as $key => $value) {
+        foreach ($this->value as $key => $value) {
             if ($value !== $erase) {
                 $list[] = $value;
             }
         }
 
-        return new static($list);
+        return $this->wrap($list);
     }
 
     /**
@@ -277,7 +422,41 @@ class ArrayList<Tv> implements
      * @return bool
      */
     public function every((function(int, Tv): bool) $callback): bool {
-        return Col::every($this->value(), $callback);
+        return Col::every($this->value, $callback);
+    }
+
+    /**
+     * Alias for Vector::filter(). Return a new ArrayList with all values that satisfy the callback.
+     *
+     * @param (function(Tv): bool) $callback
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    public function filter((function(Tv): bool) $callback): ArrayList<Tv> {
+        $start = Profiler::$enabled ? microtime(true) : 0.0;
+        $value = $this->value->filter($callback);
+
+        if ($start > 0.0) {
+            Profiler::record(static::class, __FUNCTION__, $value->count(), 0, $this->count(), $start);
+        }
+
+        return $this->wrap($value);
+    }
+
+    /**
+     * Alias for Vector::filterWithKey(). Return a new ArrayList with all values that satisfy the callback.
+     *
+     * @param (function(int, Tv): bool) $callback
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    public function filterWithKey((function(int, Tv): bool) $callback): ArrayList<Tv> {
+        $start = Profiler::$enabled ? microtime(true) : 0.0;
+        $value = $this->value->filterWithKey($callback);
+
+        if ($start > 0.0) {
+            Profiler::record(static::class, __FUNCTION__, $value->count(), 0, $this->count(), $start);
+        }
+
+        return $this->wrap($value);
     }
 
     /**
@@ -300,6 +479,36 @@ class ArrayList<Tv> implements
         return $this;
     }
 
+    /**
+     * Decode a list from the compact binary format created by `toBinary()`.
+     *
+     * @uses Titon\Type\Binary
+     *
+     * @param string $data
+     * @return $this
+     * @throws \Titon\Type\Exception\InvalidBinaryException
+     */
+    public static function fromBinary(string $data): this {
+        $value = Binary::decode($data);
+
+        if ($value instanceof static) {
+            return $value;
+        }
+
+        throw new InvalidBinaryException(sprintf('Binary data does not contain a %s', static::class));
+    }
+
+    /**
+     * Create a list that uses the vector as its internal value without copying it.
+     * The vector should not be referenced or modified outside of the list.
+     *
+     * @param Vector<Tv> $value
+     * @return $this
+     */
+    public static function fromVector(Vector<Tv> $value): this {
+        return (new static())->adopt($value);
+    }
+
     /**
      * Alias for Vector::get().  Will return the value at the specified index or return null.
      *
@@ -307,7 +516,7 @@ class ArrayList<Tv> implements
      * @return ?Tv
      */
     public function get(int $index): ?Tv {
-        return $this->value()->get($index);
+        return $this->value->get($index);
     }
 
     /**
@@ -316,7 +525,7 @@ class ArrayList<Tv> implements
      * @return KeyedIterator<int, Tv>
      */
     public function getIterator(): KeyedIterator<int, Tv> {
-        return $this->value()->getIterator();
+        return $this->value->getIterator();
     }
 
     /**
@@ -326,7 +535,39 @@ class ArrayList<Tv> implements
      * @return bool
      */
     public function has(int $index): bool {
-        return $this->value()->containsKey($index);
+        return $this->value->containsKey($index);
+    }
+
+    /**
+     * Return a HashMap of values keyed by the return value of the callback.
+     * If multiple values return the same key, the last value is kept.
+     *
+     * @param (function(Tv): Tu) $callback
+     * @return \Titon\Type\HashMap<Tu, Tv>
+     */
+    public function indexBy<Tu>((function(Tv): Tu) $callback): HashMap<Tu, Tv> {
+        $map = Map {};
+
+        foreach ($this->value as $value) {
+            $map[$callback($value)] = $value;
+        }
+
+        return (new HashMap())->adopt($map);
+    }
+
+    /**
+     * Return the values whose key from the callback is also returned by the other callback for a value
+     * of the other traversable. The other keys are hashed once, so the intersection is a single pass over each side.
+     *
+     * @param Traversable<Tr> $other
+     * @param (function(Tv): arraykey) $key
+     * @param (function(Tr): arraykey) $otherKey
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    public function intersectByKey<Tr>(Traversable<Tr> $other, (function(Tv): arraykey) $key, (function(Tr): arraykey) $otherKey): ArrayList<Tv> {
+        $keys = Join::keys($other, $otherKey);
+
+        return $this->filter($value ==> $keys->contains($key($value)));
     }
 
     /**
@@ -335,7 +576,26 @@ class ArrayList<Tv> implements
      * @return bool
      */
     public function isEmpty(): bool {
-        return $this->value()->isEmpty();
+        return $this->value->isEmpty();
+    }
+
+    /**
+     * Return a lazy list of pairs for every value and other value whose keys from the callbacks match.
+     * The join is a hash join that is only executed once the lazy list is iterated.
+     *
+     * Pairs are in the order of the values, then the other values. If the order does not matter,
+     * set ordered to false to hash whichever side is smaller, in which case the order is unspecified.
+     *
+     * @uses Titon\Type\Join
+     *
+     * @param Traversable<Tr> $other
+     * @param (function(Tv): arraykey) $leftKey
+     * @param (function(Tr): arraykey) $rightKey
+     * @param bool $ordered
+     * @return \Titon\Type\LazyList<Pair<Tv, Tr>>
+     */
+    public function join<Tr>(Traversable<Tr> $other, (function(Tv): arraykey) $leftKey, (function(Tr): arraykey) $rightKey, bool $ordered = true): LazyList<Pair<Tv, Tr>> {
+        return new LazyList(new Join($this->value, $leftKey, $other, $rightKey, false, $ordered), Vector {}, $this->refs);
     }
 
     /**
@@ -355,7 +615,13 @@ class ArrayList<Tv> implements
      * @return int
      */
     public function keyOf(Tv $value): int {
-        return $this->value()->linearSearch($value);
+        if ($this->valueIndexed && (is_int($value) || is_string($value))) {
+            $index = $this->valueIndex()->get($value);
+
+            return ($index === null) ? -1 : $index;
+        }
+
+        return $this->value->linearSearch($value);
     }
 
     /**
@@ -364,7 +630,7 @@ class ArrayList<Tv> implements
      * @return Vector<int>
      */
     public function keys(): Vector<int> {
-        return $this->value()->keys();
+        return $this->value->keys();
     }
 
     /**
@@ -376,6 +642,31 @@ class ArrayList<Tv> implements
         return $this->get($this->count() - 1);
     }
 
+    /**
+     * Return a lazy view of the list. Stages chained on the view (filter, map, skip, take, unique)
+     * are deferred and executed in a single pass once a terminal method is called.
+     *
+     * @return \Titon\Type\LazyList<Tv>
+     */
+    public function lazy(): LazyList<Tv> {
+        return new LazyList($this->value, Vector {}, $this->refs);
+    }
+
+    /**
+     * Return a lazy list of pairs for every value and other value whose keys from the callbacks match,
+     * and a pair with a null other value for every value without a match. Pairs are in the order of the values.
+     *
+     * @uses Titon\Type\Join
+     *
+     * @param Traversable<Tr> $other
+     * @param (function(Tv): arraykey) $leftKey
+     * @param (function(Tr): arraykey) $rightKey
+     * @return \Titon\Type\LazyList<Pair<Tv, ?Tr>>
+     */
+    public function leftJoin<Tr>(Traversable<Tr> $other, (function(Tv): arraykey) $leftKey, (function(Tr): arraykey) $rightKey): LazyList<Pair<Tv, ?Tr>> {
+        return new LazyList(new Join($this->value, $leftKey, $other, $rightKey, true), Vector {}, $this->refs);
+    }
+
     /**
      * Alias for Vector::count(). Return the length of the list.
      *
@@ -385,6 +676,61 @@ class ArrayList<Tv> implements
         return $this->count();
     }
 
+    /**
+     * Alias for Vector::map(). Return a new ArrayList with every value transformed by the callback.
+     *
+     * @param (function(Tv): Tu) $callback
+     * @return \Titon\Type\ArrayList<Tu>
+     */
+    public function map<Tu>((function(Tv): Tu) $callback): ArrayList<Tu> {
+        $start = Profiler::$enabled ? microtime(true) : 0.0;
+        $value = $this->value->map($callback);
+
+        if ($start > 0.0) {
+            Profiler::record(static::class, __FUNCTION__, $value->count(), 0, $this->count(), $start);
+        }
+
+        // Mapped values may have a different type, so a plain list is returned instead of a subclass
+        return (new ArrayList())->adopt($value);
+    }
+
+    /**
+     * Alias for Vector::mapWithKey(). Return a new ArrayList with every value transformed by the callback.
+     *
+     * @param (function(int, Tv): Tu) $callback
+     * @return \Titon\Type\ArrayList<Tu>
+     */
+    public function mapWithKey<Tu>((function(int, Tv): Tu) $callback): ArrayList<Tu> {
+        $start = Profiler::$enabled ? microtime(true) : 0.0;
+        $value = $this->value->mapWithKey($callback);
+
+        if ($start > 0.0) {
+            Profiler::record(static::class, __FUNCTION__, $value->count(), 0, $this->count(), $start);
+        }
+
+        // Mapped values may have a different type, so a plain list is returned instead of a subclass
+        return (new ArrayList())->adopt($value);
+    }
+
+    /**
+     * Return the largest value in the list, or null if the list is empty.
+     *
+     * @return ?Tv
+     */
+    public function max(): ?Tv {
+        $max = null;
+        $found = false;
+
+        foreach ($this->value as $value) {
+            if (!$found || $value > $max) {
+                $max = $value;
+                $found = true;
+            }
+        }
+
+        return $max;
+    }
+
     /**
      * Merge two ArrayLists together with values from the second list overwriting the first list.
      *
@@ -392,7 +738,26 @@ class ArrayList<Tv> implements
      * @return \Titon\Type\ArrayList<Tv>
      */
     public function merge(ArrayList<Tv> $value): ArrayList<Tv> {
-        return new static($this->toVector()->setAll($value->toVector()));
+        return $this->wrap($this->toVector()->setAll($value->value));
+    }
+
+    /**
+     * Return the smallest value in the list, or null if the list is empty.
+     *
+     * @return ?Tv
+     */
+    public function min(): ?Tv {
+        $min = null;
+        $found = false;
+
+        foreach ($this->value as $value) {
+            if (!$found || $value < $min) {
+                $min = $value;
+                $found = true;
+            }
+        }
+
+        return $min;
     }
 
     /**
@@ -404,8 +769,8 @@ class ArrayList<Tv> implements
     public function pluck<Tu>((function(Tv, int): Tu) $callback): Vector<Tu> {
         $list = Vector {};
 
-        foreach ($this->value() as $key => $value) {
-            $list[] = call_user_func_array($callback, [$value, $key]);
+        foreach ($this->value as $key => $value) {
+            $list[] = $callback($value, $key);
         }
 
         return $list;
@@ -421,6 +786,47 @@ class ArrayList<Tv> implements
         return $this->concat(new ArrayList(Vector {$value}), false);
     }
 
+    /**
+     * Return the product of all values in the list, or 1 if the list is empty.
+     * The values are expected to be numeric.
+     *
+     * @return num
+     */
+    public function product(): num {
+        // UNSAFE
+        // Values are not constrained to numbers
+        $product = 1;
+
+        foreach ($this->value as $value) {
+            $product *= $value;
+        }
+
+        return $product;
+    }
+
+    /**
+     * Reduce the list to a single value by passing the accumulated value and each value to the callback,
+     * starting with the initial value.
+     *
+     * @param (function(Tu, Tv): Tu) $callback
+     * @param Tu $initial
+     * @return Tu
+     */
+    public function reduce<Tu>((function(Tu, Tv): Tu) $callback, Tu $initial): Tu {
+        $start = Profiler::$enabled ? microtime(true) : 0.0;
+        $result = $initial;
+
+        foreach ($this->value as $value) {
+            $result = $callback($result, $value);
+        }
+
+        if ($start > 0.0) {
+            Profiler::record(static::class, __FUNCTION__, 0, 0, $this->count(), $start);
+        }
+
+        return $result;
+    }
+
     /**
      * Remove an item at the specific index. This will reorder indices.
      *
@@ -428,7 +834,8 @@ class ArrayList<Tv> implements
      * @return $this
      */
     public function remove(int $index): this {
-        $this->value()->removeKey($index);
+        $this->detach()->removeKey($index);
+        $this->invalidate();
 
         return $this;
     }
@@ -439,7 +846,41 @@ class ArrayList<Tv> implements
      * @return string
      */
     public function serialize(): string {
-        return serialize($this->value());
+        return serialize($this->value);
+    }
+
+    /**
+     * Alias for Vector::set(). Overwrite the value at the specified index.
+     *
+     * @param int $index
+     * @param Tv $value
+     * @return $this
+     */
+    public function set(int $index, Tv $value): this {
+        $vector = $this->detach();
+        $previous = $vector->get($index);
+
+        $vector->set($index, $value);
+
+        $this->reindexValue($index, $previous, $value);
+
+        return $this;
+    }
+
+    /**
+     * Return a read-only view over a range of the list. The values are not copied,
+     * and any modifications to the list after slicing will not be reflected in the slice.
+     *
+     * @param int $offset
+     * @param int $length
+     * @return \Titon\Type\ListSlice<Tv>
+     */
+    public function slice(int $offset, ?int $length = null): ListSlice<Tv> {
+        if ($length === null) {
+            $length = $this->count() - $offset;
+        }
+
+        return new ListSlice($this->value, $offset, $length, $this->refs);
     }
 
     /**
@@ -451,7 +892,7 @@ class ArrayList<Tv> implements
      * @return bool
      */
     public function some((function(int, Tv): bool) $callback): bool {
-        return Col::some($this->value(), $callback);
+        return Col::some($this->value, $callback);
     }
 
     /**
@@ -470,7 +911,35 @@ class ArrayList<Tv> implements
             sort($list, $flags);
         }
 
-        return new static($list);
+        return $this->wrap($list);
+    }
+
+    /**
+     * Sort the items in the list by the value returned from the callback. The callback is called once per item,
+     * instead of twice per comparison, which makes this faster than `sort()` when deriving the sort key is costly.
+     *
+     * @param (function(Tv): mixed) $callback
+     * @param int $flags
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    public function sortBy((function(Tv): mixed) $callback, int $flags = SORT_REGULAR): ArrayList<Tv> {
+        $value = $this->value;
+        $keys = [];
+
+        foreach ($value as $index => $item) {
+            $keys[$index] = $callback($item);
+        }
+
+        asort($keys, $flags);
+
+        $list = Vector {};
+        $list->reserve(count($keys));
+
+        foreach ($keys as $index => $key) {
+            $list[] = $value[$index];
+        }
+
+        return $this->wrap($list);
     }
 
     /**
@@ -481,15 +950,42 @@ class ArrayList<Tv> implements
      * @return \Titon\Type\ArrayList<Tv>
      */
     public function sortNatural(bool $sensitive = false): ArrayList<Tv> {
-        $list = $this->toArray();
+        $list = $this->toVector();
 
-        if ($sensitive) {
-            natsort($list);
-        } else {
-            natcasesort($list);
+        // Sort the copy in place instead of sorting an array and re-indexing it
+        usort($list, $sensitive ? fun('strnatcmp') : fun('strnatcasecmp'));
+
+        return $this->wrap($list);
+    }
+
+    /**
+     * Return an iterator that yields the items in sorted order on demand, using the callback or ascending order.
+     * The heap is built in O(n) and each item costs O(log n) once requested, so stopping early
+     * avoids the cost of a full sort.
+     *
+     * @param (function(Tv, Tv): int) $callback
+     * @return Iterator<Tv>
+     */
+    public function sorted(?(function(Tv, Tv): int) $callback = null): Iterator<Tv> {
+        return (new Heap($callback, $this->value))->drain();
+    }
+
+    /**
+     * Return the sum of all values in the list, or 0 if the list is empty.
+     * The values are expected to be numeric.
+     *
+     * @return num
+     */
+    public function sum(): num {
+        // UNSAFE
+        // Values are not constrained to numbers
+        $sum = 0;
+
+        foreach ($this->value as $value) {
+            $sum += $value;
         }
 
-        return new static(array_values($list));
+        return $sum;
     }
 
     /**
@@ -498,7 +994,22 @@ class ArrayList<Tv> implements
      * @return array<int, Tv>
      */
     public function toArray(): array<int, Tv> {
-        return $this->value()->toArray();
+        if (Profiler::$enabled) {
+            Profiler::record(static::class, __FUNCTION__, $this->count());
+        }
+
+        return $this->value->toArray();
+    }
+
+    /**
+     * Return the list encoded in a compact binary format, which is smaller and faster to decode than `serialize()`.
+     *
+     * @uses Titon\Type\Binary
+     *
+     * @return string
+     */
+    public function toBinary(): string {
+        return Binary::encode($this);
     }
 
     /**
@@ -508,7 +1019,11 @@ class ArrayList<Tv> implements
      * @return string
      */
     public function toJson(int $options = 0): string {
-        return json_encode($this, $options);
+        $sink = new BufferSink();
+
+        $this->writeJson($sink, $options);
+
+        return $sink->toString();
     }
 
     /**
@@ -517,7 +1032,20 @@ class ArrayList<Tv> implements
      * @return Map<int, Tv>
      */
     public function toMap(): Map<int, Tv> {
-        return $this->value()->toMap();
+        if (Profiler::$enabled) {
+            Profiler::record(static::class, __FUNCTION__, $this->count());
+        }
+
+        return $this->value->toMap();
+    }
+
+    /**
+     * Return the list as a persistent list, which supports cheap copies on append and set.
+     *
+     * @return \Titon\Type\PersistentList<Tv>
+     */
+    public function toPersistent(): PersistentList<Tv> {
+        return new PersistentList($this->value);
     }
 
     /**
@@ -526,7 +1054,11 @@ class ArrayList<Tv> implements
      * @return Vector<Tv>
      */
     public function toVector(): Vector<Tv> {
-        return $this->value()->toVector();
+        if (Profiler::$enabled) {
+            Profiler::record(static::class, __FUNCTION__, $this->count());
+        }
+
+        return $this->value->toVector();
     }
 
     /**
@@ -537,7 +1069,23 @@ class ArrayList<Tv> implements
      * @return string
      */
     public function toXml(string $root = 'items', string $item = 'item'): string {
-        return Xml::fromVector($root, $item, $this->value())->toString();
+        $sink = new BufferSink();
+
+        $this->writeXml($sink, $root, $item);
+
+        return $sink->toString();
+    }
+
+    /**
+     * Return the first K items that a sort with the callback would produce, in sorted order.
+     * Uses a bounded heap, so only K items are held and sorted, at O(n log k).
+     *
+     * @param int $k
+     * @param (function(Tv, Tv): int) $callback
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    public function topK(int $k, ?(function(Tv, Tv): int) $callback = null): ArrayList<Tv> {
+        return $this->wrap($this->select($k, $callback ?: Heap::natural()));
     }
 
     /**
@@ -546,26 +1094,141 @@ class ArrayList<Tv> implements
      * @param string $value
      */
     public function unserialize(/* HH_FIXME[4032]: no type hint */ $value): void {
-        $this->write(unserialize($value));
+        $value = unserialize($value);
+
+        // The constructor is not called during unserialization
+        $this->refs = new RefCount();
+
+        // The unserialized vector is not referenced elsewhere so it can be used directly
+        if ($value instanceof Vector) {
+            $this->adopt($value);
+        } else {
+            $this->write($value);
+        }
     }
 
     /**
-     * Removes duplicate values from the list.
+     * Return the values of both lists without duplicates, keeping the first occurrence.
+     * Values are compared by the return value of the callback if one is defined.
+     *
+     * @param ArrayList<Tv> $value
+     * @param (function(Tv): arraykey) $callback
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    public function union(ArrayList<Tv> $value, ?(function(Tv): arraykey) $callback = null): ArrayList<Tv> {
+        $list = $this->concat($value);
+
+        return ($callback === null) ? $list->unique() : $list->uniqueBy($callback);
+    }
+
+    /**
+     * Removes duplicate values from the list, keeping the first occurrence of each value.
+     * Values are compared the same as `array_unique()` with the defined flags, unless strict is true,
+     * in which case the flags are ignored and values are compared by type and value (`1` and `"1"` are different).
+     *
+     * When strict, integers and strings are deduplicated by hash and other values by strict comparison, in a single pass.
+     * Otherwise, lists of values that can be hashed without changing how they compare (integers, or strings that
+     * are not numeric) are deduplicated by hash in a single pass instead of using `array_unique()`.
      *
      * @param int $flags
+     * @param bool $strict
      * @return \Titon\Type\ArrayList<Tv>
      */
-    public function unique(int $flags = SORT_REGULAR): ArrayList<Tv> {
+    public function unique(int $flags = SORT_REGULAR, bool $strict = false): ArrayList<Tv> {
+        if ($strict) {
+            $seen = Set {};
+            $others = Vector {};
+            $list = Vector {};
+
+            foreach ($this->value as $value) {
+
+                // Values that can not be hashed are checked by strict comparison, the same as LazyList::unique()
+                if (is_int($value) || is_string($value)) {
+                    if ($seen->contains($value)) {
+                        continue;
+                    }
+
+                    $seen[] = $value;
+
+                } else {
+                    if (in_array($value, $others, true)) {
+                        continue;
+                    }
+
+                    $others[] = $value;
+                }
+
+                $list[] = $value;
+            }
+
+            return $this->wrap($list);
+        }
+
+        if ($flags === SORT_REGULAR) {
+            $seen = Set {};
+            $list = Vector {};
+            $ints = false;
+            $strings = false;
+            $hashable = true;
+
+            foreach ($this->value as $value) {
+                if (is_int($value)) {
+                    $ints = true;
+
+                // Numeric strings are compared as numbers
+                } else if (is_string($value) && !is_numeric($value)) {
+                    $strings = true;
+
+                } else {
+                    $hashable = false;
+                    break;
+                }
+
+                if (!$seen->contains($value)) {
+                    $seen[] = $value;
+                    $list[] = $value;
+                }
+            }
+
+            // Integers and strings can be loosely equal to each other
+            if ($hashable && !($ints && $strings)) {
+                return $this->wrap($list);
+            }
+        }
+
         return new static(array_unique($this->toArray(), $flags));
     }
 
     /**
-     * Return the raw value.
+     * Removes values that return the same key from the callback, keeping the first occurrence, in a single pass.
+     *
+     * @param (function(Tv): arraykey) $callback
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    public function uniqueBy((function(Tv): arraykey) $callback): ArrayList<Tv> {
+        $seen = Set {};
+        $list = Vector {};
+
+        foreach ($this->value as $value) {
+            $key = $callback($value);
+
+            if (!$seen->contains($key)) {
+                $seen[] = $key;
+                $list[] = $value;
+            }
+        }
+
+        return $this->wrap($list);
+    }
+
+    /**
+     * Return a copy of the raw value, which can be modified without affecting this or any other list.
+     * Use `view()` to read the raw value without copying it.
      *
      * @return Vector<Tv>
      */
     public function value(): Vector<Tv> {
-        return $this->value;
+        return $this->value->toVector();
     }
 
     /**
@@ -574,7 +1237,29 @@ class ArrayList<Tv> implements
      * @return Vector<Tv>
      */
     public function values(): Vector<Tv> {
-        return $this->value()->values();
+        return $this->value->values();
+    }
+
+    /**
+     * Return the raw value without copying it. The vector may be shared with other lists and is read only.
+     *
+     * @return ConstVector<Tv>
+     */
+    public function view(): ConstVector<Tv> {
+        return $this->value;
+    }
+
+    /**
+     * Enable the value index, which maps hashable (integer and string) values to their first index.
+     * Once enabled, `contains()`, `keyOf()`, and `erase()` resolve hashable values in constant time,
+     * while other values fall back to scanning the list.
+     *
+     * @return $this
+     */
+    public function withValueIndex(): this {
+        $this->valueIndexed = true;
+
+        return $this;
     }
 
     /**
@@ -584,9 +1269,197 @@ class ArrayList<Tv> implements
      * @return $this
      */
     public function write(Indexish<int, Tv> $value): this {
-        $this->value = new Vector($value);
+        $this->adopt(new Vector($value));
+        $this->invalidate();
+
+        return $this;
+    }
+
+    /**
+     * Write the list as JSON to a sink, walking nested lists and maps in place instead of
+     * converting them to arrays first.
+     *
+     * @uses Titon\Type\Json\Writer
+     *
+     * @param \Titon\Type\Sink $sink
+     * @param int $options
+     * @return $this
+     */
+    public function writeJson(Sink $sink, int $options = 0): this {
+        (new JsonWriter($sink, $options))->write($this);
+
+        return $this;
+    }
+
+    /**
+     * Write the list as XML to a sink, without building an Element tree first.
+     *
+     * @uses Titon\Type\Xml\Writer
+     *
+     * @param \Titon\Type\Sink $sink
+     * @param string $root
+     * @param string $item
+     * @return $this
+     */
+    public function writeXml(Sink $sink, string $root = 'items', string $item = 'item'): this {
+        (new XmlWriter($sink))->writeVector($root, $item, $this->value);
+
+        return $this;
+    }
+
+    /**
+     * Use the vector as the internal value without copying it.
+     * The vector should not be referenced or modified outside of this list.
+     *
+     * @param Vector<Tv> $value
+     * @return $this
+     */
+    protected function adopt(Vector<Tv> $value): this {
+        if ($this->refs->isShared()) {
+            $this->refs->release();
+            $this->refs = new RefCount();
+        }
+
+        $this->value = $value;
 
         return $this;
     }
 
+    /**
+     * Update the value index for a value that is about to be appended to the list.
+     *
+     * @param Tv $value
+     */
+    protected function appendIndex(Tv $value): void {
+        $values = $this->valueIndex;
+
+        if ($values !== null && (is_int($value) || is_string($value)) && !$values->containsKey($value)) {
+            $values[$value] = $this->count();
+        }
+    }
+
+    /**
+     * Copy the internal vector if it is shared with other lists, so that it can be safely modified.
+     *
+     * @return Vector<Tv>
+     */
+    protected function detach(): Vector<Tv> {
+        if ($this->refs->isShared()) {
+            if (Profiler::$enabled) {
+                Profiler::record(static::class, Profiler::caller(), $this->value->count());
+            }
+
+            $this->adopt($this->value->toVector());
+        }
+
+        return $this->value;
+    }
+
+    /**
+     * Reset all lazily built indexes. Should be called after the list has been modified.
+     */
+    protected function invalidate(): void {
+        $this->valueIndex = null;
+    }
+
+    /**
+     * Update the value index after the value at the specified index has been replaced.
+     *
+     * @param int $index
+     * @param Tv $previous
+     * @param Tv $value
+     */
+    protected function reindexValue(int $index, ?Tv $previous, Tv $value): void {
+        $values = $this->valueIndex;
+
+        if ($values === null || $previous === $value) {
+            return;
+        }
+
+        // The replaced value may appear later in the list, which can only be found by rebuilding
+        if ((is_int($previous) || is_string($previous)) && $values->get($previous) === $index) {
+            $this->valueIndex = null;
+
+            return;
+        }
+
+        if (is_int($value) || is_string($value)) {
+            $first = $values->get($value);
+
+            if ($first === null || $first > $index) {
+                $values[$value] = $index;
+            }
+        }
+    }
+
+    /**
+     * Select the first K items in the order of the callback, by keeping the best K items seen so far
+     * in a heap whose top is the worst of them. The items are returned in sorted order.
+     *
+     * @param int $k
+     * @param (function(Tv, Tv): int) $callback
+     * @return Vector<Tv>
+     */
+    protected function select(int $k, (function(Tv, Tv): int) $callback): Vector<Tv> {
+        $list = Vector {};
+
+        if ($k <= 0) {
+            return $list;
+        }
+
+        $heap = new Heap(($a, $b) ==> $callback($b, $a));
+
+        foreach ($this->value as $value) {
+            if ($heap->count() < $k) {
+                $heap->push($value);
+
+            // Replace the worst of the selected items
+            } else if ($callback($value, $heap->top()) < 0) {
+                $heap->replace($value);
+            }
+        }
+
+        // The heap yields the worst item first
+        foreach ($heap->drain() as $value) {
+            $list[] = $value;
+        }
+
+        $list->reverse();
+
+        return $list;
+    }
+
+    /**
+     * Return the value index, building it if it does not exist.
+     *
+     * @return Map<arraykey, int>
+     */
+    protected function valueIndex(): Map<arraykey, int> {
+        $values = $this->valueIndex;
+
+        if ($values === null) {
+            $values = Map {};
+
+            foreach ($this->value as $index => $value) {
+                if ((is_int($value) || is_string($value)) && !$values->containsKey($value)) {
+                    $values[$value] = $index;
+                }
+            }
+
+            $this->valueIndex = $values;
+        }
+
+        return $values;
+    }
+
+    /**
+     * Return a new list that uses the vector as its internal value without copying it.
+     *
+     * @param Vector<Tv> $value
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    protected function wrap(Vector<Tv> $value): ArrayList<Tv> {
+        return (new static())->adopt($value);
+    }
+
 }
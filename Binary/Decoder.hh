@@ -0,0 +1,344 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Binary;
+
+use Titon\Type\ArrayList;
+use Titon\Type\Binary;
+use Titon\Type\Exception\InvalidBinaryException;
+use Titon\Type\HashMap;
+use Titon\Type\Xml\Element;
+
+/**
+ * The Decoder reads values from the compact binary format described by the Binary class.
+ *
+ * @package Titon\Type\Binary
+ */
+class Decoder {
+
+    /**
+     * The data being decoded.
+     *
+     * @var string
+     */
+    protected string $data = '';
+
+    /**
+     * Length of the data.
+     *
+     * @var int
+     */
+    protected int $length = 0;
+
+    /**
+     * Current read position within the data.
+     *
+     * @var int
+     */
+    protected int $offset = 0;
+
+    /**
+     * Strings in the order they were first read.
+     *
+     * @var Vector<string>
+     */
+    protected Vector<string> $strings = Vector {};
+
+    /**
+     * Decode the binary data and return the value.
+     *
+     * @param string $data
+     * @return mixed
+     * @throws \Titon\Type\Exception\InvalidBinaryException
+     */
+    public function decode(string $data): mixed {
+        $header = strlen(Binary::HEADER);
+
+        if (substr($data, 0, $header) !== Binary::HEADER) {
+            throw new InvalidBinaryException('Binary data has an invalid header');
+        }
+
+        $this->data = $data;
+        $this->length = strlen($data);
+        $this->offset = $header;
+        $this->strings = Vector {};
+
+        try {
+            $value = $this->readValue();
+
+            if ($this->offset !== $this->length) {
+                throw new InvalidBinaryException('Binary data has trailing bytes');
+            }
+
+            return $value;
+
+        } finally {
+            $this->data = '';
+            $this->strings = Vector {};
+        }
+    }
+
+    /**
+     * Read a number of raw bytes.
+     *
+     * @param int $length
+     * @return string
+     * @throws \Titon\Type\Exception\InvalidBinaryException
+     */
+    protected function read(int $length): string {
+        if ($length < 0 || ($this->offset + $length) > $this->length) {
+            throw new InvalidBinaryException('Unexpected end of binary data');
+        }
+
+        $bytes = substr($this->data, $this->offset, $length);
+        $this->offset += $length;
+
+        return $bytes;
+    }
+
+    /**
+     * Read a single byte as an integer.
+     *
+     * @return int
+     * @throws \Titon\Type\Exception\InvalidBinaryException
+     */
+    protected function readByte(): int {
+        if ($this->offset >= $this->length) {
+            throw new InvalidBinaryException('Unexpected end of binary data');
+        }
+
+        return ord($this->data[$this->offset++]);
+    }
+
+    /**
+     * Read a class name and verify that it extends the expected class.
+     *
+     * @param string $parent
+     * @return string
+     * @throws \Titon\Type\Exception\InvalidBinaryException
+     */
+    protected function readClass(string $parent): string {
+        $class = $this->readString();
+
+        if (!is_a($class, $parent, true)) {
+            throw new InvalidBinaryException(sprintf('Binary class %s is not a %s', $class, $parent));
+        }
+
+        return $class;
+    }
+
+    /**
+     * Read an element and all of its descendants.
+     *
+     * @param bool $top
+     * @return \Titon\Type\Xml\Element
+     */
+    protected function readElement(bool $top): Element {
+        $element = new Element($this->readString());
+
+        foreach ($this->readStrings() as $key => $value) {
+            $element->setAttribute($key, $value);
+        }
+
+        foreach ($this->readStrings() as $key => $value) {
+            $element->setNamespace($key, $value);
+        }
+
+        $value = $this->readString();
+
+        if ($value !== '') {
+            $element->setValue($value);
+        }
+
+        if ($top) {
+            $element->getDeclaration()->setAll($this->readStrings());
+        }
+
+        for ($i = $this->readVarint(); $i > 0; $i--) {
+            $element->addChild($this->readElement(false));
+        }
+
+        return $element;
+    }
+
+    /**
+     * Read a count of pairs followed by each key and value.
+     *
+     * @return Map<mixed, mixed>
+     */
+    protected function readPairs(): Map<mixed, mixed> {
+        // UNSAFE
+        // Keys are decoded as mixed values
+        $map = Map {};
+
+        for ($i = $this->readVarint(); $i > 0; $i--) {
+            $key = $this->readValue();
+            $map[$key] = $this->readValue();
+        }
+
+        return $map;
+    }
+
+    /**
+     * Read a string without a type tag, either the raw bytes or a reference into the string table.
+     *
+     * @return string
+     * @throws \Titon\Type\Exception\InvalidBinaryException
+     */
+    protected function readString(): string {
+        $header = $this->readVarint();
+        $strings = $this->strings;
+
+        if ($header & 1) {
+            $index = $header >> 1;
+
+            if (!$strings->containsKey($index)) {
+                throw new InvalidBinaryException(sprintf('Binary string reference %s does not exist', $index));
+            }
+
+            return $strings[$index];
+        }
+
+        $value = $this->read($header >> 1);
+        $strings[] = $value;
+
+        return $value;
+    }
+
+    /**
+     * Read a map of strings without type tags.
+     *
+     * @return Map<string, string>
+     */
+    protected function readStrings(): Map<string, string> {
+        $map = Map {};
+
+        for ($i = $this->readVarint(); $i > 0; $i--) {
+            $key = $this->readString();
+            $map[$key] = $this->readString();
+        }
+
+        return $map;
+    }
+
+    /**
+     * Read a value and its type tag.
+     *
+     * @return mixed
+     * @throws \Titon\Type\Exception\InvalidBinaryException
+     */
+    protected function readValue(): mixed {
+        // UNSAFE
+        // Wrapper classes are instantiated from the class name stored in the data
+        $type = $this->readByte();
+
+        switch ($type) {
+            case Binary::TYPE_NULL:
+                return null;
+
+            case Binary::TYPE_FALSE:
+                return false;
+
+            case Binary::TYPE_TRUE:
+                return true;
+
+            case Binary::TYPE_INT:
+                $value = $this->readVarint();
+
+                // Reverse the zigzag encoding
+                return (($value >> 1) & PHP_INT_MAX) ^ -($value & 1);
+
+            case Binary::TYPE_FLOAT:
+                return unpack('d', $this->read(8))[1];
+
+            case Binary::TYPE_STRING:
+                return $this->readString();
+
+            case Binary::TYPE_VECTOR:
+                return $this->readValues();
+
+            case Binary::TYPE_MAP:
+                return $this->readPairs();
+
+            case Binary::TYPE_SET:
+                return new Set($this->readValues());
+
+            case Binary::TYPE_ARRAY:
+                $array = [];
+
+                for ($i = $this->readVarint(); $i > 0; $i--) {
+                    $key = $this->readValue();
+                    $array[$key] = $this->readValue();
+                }
+
+                return $array;
+
+            case Binary::TYPE_LIST:
+                $class = $this->readClass(ArrayList::class);
+
+                // The decoded vector is not referenced elsewhere so it can be used directly
+                return $class::fromVector($this->readValues());
+
+            case Binary::TYPE_HASHMAP:
+                $class = $this->readClass(HashMap::class);
+
+                return $class::fromMap($this->readPairs());
+
+            case Binary::TYPE_ELEMENT:
+                return $this->readElement(true);
+
+            case Binary::TYPE_SERIALIZED:
+                // Objects are never instantiated, as that would bypass the class checks of the other types
+                return unserialize($this->read($this->readVarint()), ['allowed_classes' => false]);
+        }
+
+        throw new InvalidBinaryException(sprintf('Unknown binary type %s at offset %s', $type, $this->offset - 1));
+    }
+
+    /**
+     * Read a count of values followed by each value.
+     *
+     * @return Vector<mixed>
+     */
+    protected function readValues(): Vector<mixed> {
+        $count = $this->readVarint();
+        $values = Vector {};
+
+        // Every value takes at least a byte, so corrupt counts can not reserve more than the data allows
+        $values->reserve(min($count, $this->length - $this->offset));
+
+        for ($i = $count; $i > 0; $i--) {
+            $values[] = $this->readValue();
+        }
+
+        return $values;
+    }
+
+    /**
+     * Read an unsigned variable length integer.
+     *
+     * @return int
+     * @throws \Titon\Type\Exception\InvalidBinaryException
+     */
+    protected function readVarint(): int {
+        $value = 0;
+        $shift = 0;
+
+        do {
+            if ($shift > 63) {
+                throw new InvalidBinaryException('Binary varint is too long');
+            }
+
+            $byte = $this->readByte();
+            $value |= ($byte & 0x7F) << $shift;
+            $shift += 7;
+        } while ($byte & 0x80);
+
+        return $value;
+    }
+
+}
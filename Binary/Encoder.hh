@@ -0,0 +1,227 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Binary;
+
+use Titon\Type\ArrayList;
+use Titon\Type\Binary;
+use Titon\Type\HashMap;
+use Titon\Type\Xml\Element;
+
+/**
+ * The Encoder writes values into the compact binary format described by the Binary class.
+ *
+ * @package Titon\Type\Binary
+ */
+class Encoder {
+
+    /**
+     * The encoded output.
+     *
+     * @var string
+     */
+    protected string $buffer = '';
+
+    /**
+     * Strings that have been written, mapped to their position in the string table.
+     *
+     * @var Map<string, int>
+     */
+    protected Map<string, int> $strings = Map {};
+
+    /**
+     * Encode a value and return the binary output.
+     *
+     * @param mixed $value
+     * @return string
+     */
+    public function encode(mixed $value): string {
+        $this->buffer = Binary::HEADER;
+        $this->strings = Map {};
+
+        $this->writeValue($value);
+
+        $buffer = $this->buffer;
+
+        // Release the buffer and string table
+        $this->buffer = '';
+        $this->strings = Map {};
+
+        return $buffer;
+    }
+
+    /**
+     * Write an element and all of its descendants. The declaration is only written for the top level element.
+     *
+     * @param \Titon\Type\Xml\Element $element
+     * @param bool $top
+     */
+    protected function writeElement(Element $element, bool $top): void {
+        $this->writeString($element->getName());
+        $this->writeStrings($element->hasAttributes() ? $element->getAttributes() : Map {});
+        $this->writeStrings($element->hasNamespaces() ? $element->getNamespaces() : Map {});
+        $this->writeString($element->getValue());
+
+        if ($top) {
+            $this->writeStrings($element->getDeclaration());
+        }
+
+        $this->writeVarint($element->count());
+
+        foreach ($element->getIterator() as $child) {
+            $this->writeElement($child, false);
+        }
+    }
+
+    /**
+     * Write the count of pairs followed by each key and value.
+     *
+     * @param KeyedTraversable<mixed, mixed> $pairs
+     * @param int $count
+     */
+    protected function writePairs(KeyedTraversable<mixed, mixed> $pairs, int $count): void {
+        $this->writeVarint($count);
+
+        foreach ($pairs as $key => $value) {
+            $this->writeValue($key);
+            $this->writeValue($value);
+        }
+    }
+
+    /**
+     * Write a string without a type tag. The first occurrence of a string is written as its length and bytes,
+     * while repeated strings are written as a reference to their position in the string table.
+     * The lowest bit of the leading varint distinguishes the two.
+     *
+     * @param string $value
+     */
+    protected function writeString(string $value): void {
+        $strings = $this->strings;
+
+        if ($strings->contains($value)) {
+            $this->writeVarint(($strings[$value] << 1) | 1);
+
+        } else {
+            $strings[$value] = $strings->count();
+
+            $this->writeVarint(strlen($value) << 1);
+            $this->buffer .= $value;
+        }
+    }
+
+    /**
+     * Write a map of strings without type tags.
+     *
+     * @param Map<string, string> $map
+     */
+    protected function writeStrings(Map<string, string> $map): void {
+        $this->writeVarint($map->count());
+
+        foreach ($map as $key => $value) {
+            $this->writeString($key);
+            $this->writeString($value);
+        }
+    }
+
+    /**
+     * Write a value with its type tag.
+     *
+     * @param mixed $value
+     */
+    protected function writeValue(mixed $value): void {
+        if ($value === null) {
+            $this->buffer .= chr(Binary::TYPE_NULL);
+
+        } else if (is_bool($value)) {
+            $this->buffer .= chr($value ? Binary::TYPE_TRUE : Binary::TYPE_FALSE);
+
+        } else if (is_int($value)) {
+            $this->buffer .= chr(Binary::TYPE_INT);
+
+            // Zigzag encode so that small negative numbers stay small
+            $this->writeVarint(($value << 1) ^ ($value >> 63));
+
+        } else if (is_float($value)) {
+            $this->buffer .= chr(Binary::TYPE_FLOAT) . pack('d', $value);
+
+        } else if (is_string($value)) {
+            $this->buffer .= chr(Binary::TYPE_STRING);
+            $this->writeString($value);
+
+        } else if ($value instanceof ArrayList) {
+            $this->buffer .= chr(Binary::TYPE_LIST);
+            $this->writeString(get_class($value));
+            $this->writeValues($value->view(), $value->count());
+
+        } else if ($value instanceof HashMap) {
+            $this->buffer .= chr(Binary::TYPE_HASHMAP);
+            $this->writeString(get_class($value));
+            $this->writePairs($value->view(), $value->count());
+
+        } else if ($value instanceof Element) {
+            $this->buffer .= chr(Binary::TYPE_ELEMENT);
+            $this->writeElement($value, true);
+
+        } else if ($value instanceof Vector) {
+            $this->buffer .= chr(Binary::TYPE_VECTOR);
+            $this->writeValues($value, $value->count());
+
+        } else if ($value instanceof Map) {
+            $this->buffer .= chr(Binary::TYPE_MAP);
+            $this->writePairs($value, $value->count());
+
+        } else if ($value instanceof Set) {
+            $this->buffer .= chr(Binary::TYPE_SET);
+            $this->writeValues($value, $value->count());
+
+        } else if (is_array($value)) {
+            $this->buffer .= chr(Binary::TYPE_ARRAY);
+            $this->writePairs($value, count($value));
+
+        } else {
+            $serialized = serialize($value);
+
+            $this->buffer .= chr(Binary::TYPE_SERIALIZED);
+            $this->writeVarint(strlen($serialized));
+            $this->buffer .= $serialized;
+        }
+    }
+
+    /**
+     * Write the count of values followed by each value.
+     *
+     * @param Traversable<mixed> $values
+     * @param int $count
+     */
+    protected function writeValues(Traversable<mixed> $values, int $count): void {
+        $this->writeVarint($count);
+
+        foreach ($values as $value) {
+            $this->writeValue($value);
+        }
+    }
+
+    /**
+     * Write an integer as an unsigned variable length integer, using 7 bits per byte.
+     * The highest bit of each byte is set if more bytes follow.
+     *
+     * @param int $value
+     */
+    protected function writeVarint(int $value): void {
+        $bytes = '';
+
+        while (($value & ~0x7F) !== 0) {
+            $bytes .= chr(($value & 0x7F) | 0x80);
+
+            // Logical shift, so that values with the sign bit set terminate
+            $value = ($value >> 7) & (PHP_INT_MAX >> 6);
+        }
+
+        $this->buffer .= $bytes . chr($value);
+    }
+
+}
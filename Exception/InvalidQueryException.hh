@@ -0,0 +1,17 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Exception;
+
+/**
+ * Exception thrown when an element query path can not be compiled.
+ *
+ * @package Titon\Type\Exception
+ */
+class InvalidQueryException extends \InvalidArgumentException {
+
+}
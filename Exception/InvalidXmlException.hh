@@ -0,0 +1,17 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Exception;
+
+/**
+ * Exception thrown when an XML document is malformed and can not be parsed.
+ *
+ * @package Titon\Type\Exception
+ */
+class InvalidXmlException extends \UnexpectedValueException {
+
+}
@@ -0,0 +1,17 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Exception;
+
+/**
+ * Exception thrown when a file or URL can not be read from or written to.
+ *
+ * @package Titon\Type\Exception
+ */
+class StreamException extends \RuntimeException {
+
+}
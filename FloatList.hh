@@ -0,0 +1,32 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+/**
+ * The FloatList is an extension of the NumericList for lists of floats, like lists of prices.
+ *
+ * @package Titon\Type
+ */
+class FloatList extends NumericList<float> {
+
+    /**
+     * Return the sum of all floats.
+     *
+     * @return float
+     */
+    public function sum(): float {
+        $sum = 0.0;
+
+        foreach ($this->value as $value) {
+            $sum += $value;
+        }
+
+        return $sum;
+    }
+
+}
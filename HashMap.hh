@@ -12,8 +12,12 @@ use Titon\Common\Jsonable;
 use Titon\Common\Mapable;
 use Titon\Common\Vectorable;
 use Titon\Common\Xmlable;
+use Titon\Type\Exception\InvalidBinaryException;
 use Titon\Type\Exception\MissingMethodException;
+use Titon\Type\Json\Writer as JsonWriter;
+use Titon\Type\Sink\BufferSink;
 use Titon\Type\Xml;
+use Titon\Type\Xml\Writer as XmlWriter;
 use Titon\Utility\Col;
 use \ArrayAccess;
 use \Countable;
@@ -27,14 +31,10 @@ use \Indexish;
  * integration with built-in Map methods through PHP magic methods, and a easily fluent chainable API.
  *
  * @package Titon\Type
- * @method $this add(Pair<Tk, Tv> $value)
  * @method $this addAll(Traversable<Pair<Tk, Tv>> $values)
  * @method $this clear()
- * @method HashMap filter((function(Tv): bool) $callback)
- * @method HashMap filterWithKey((function(Tk, Tv): bool) $callback)
- * @method HashMap map((function(Tv): Tu) $callback)
- * @method HashMap mapWithKey((function(Tk, Tv): Tu) $callback)
- * @method $this set(Tk $key, Tv $value)
+ * @method $this removeKey(Tk $key)
+ * @method $this reserve(int $size)
  * @method $this setAll(KeyedTraversable<Tk, Tv> $values)
  */
 class HashMap<Tk, Tv> implements
@@ -50,23 +50,35 @@ class HashMap<Tk, Tv> implements
 
     /**
      * Methods on the Map collection that should be chainable through HashMap.
+     * Frequently used methods (add, set) are defined directly and do not use magic dispatch.
      *
-     * @var Vector<string>
+     * @var ImmSet<string>
      */
-    protected Vector<string> $chainable = Vector {
-        'add', 'addAll', 'clear', 'removeKey',
-        'reserve', 'resize', 'set', 'setAll'
+    protected static ImmSet<string> $chainable = ImmSet {
+        'addAll', 'clear', 'removeKey',
+        'reserve', 'setAll'
     };
 
     /**
-     * Methods on the Map collection that should return a new HashMap instance.
+     * Lazily built list of keys in insertion order, used for positional lookups.
      *
-     * @var Vector<string>
+     * @var Vector<Tk>
      */
-    protected Vector<string> $immutable = Vector {
-        'filter', 'filterWithKey', 'map', 'mapWithKey',
-        'reverse', 'shuffle', 'splice'
-    };
+    protected ?Vector<Tk> $keyIndex = null;
+
+    /**
+     * Lazily built mapping of keys to their position within the map.
+     *
+     * @var Map<Tk, int>
+     */
+    protected ?Map<Tk, int> $positionIndex = null;
+
+    /**
+     * Tracks how many maps share the internal Map.
+     *
+     * @var \Titon\Type\RefCount
+     */
+    protected RefCount $refs;
 
     /**
      * Raw internal Map used for list management.
@@ -75,17 +87,34 @@ class HashMap<Tk, Tv> implements
      */
     protected Map<Tk, Tv> $value = Map {};
 
+    /**
+     * Lazily built mapping of hashable values to the first key they appear at.
+     * Only used when value indexing has been enabled.
+     *
+     * @var Map<arraykey, Tk>
+     */
+    protected ?Map<arraykey, Tk> $valueIndex = null;
+
+    /**
+     * Whether value lookups should use the value index.
+     *
+     * @var bool
+     */
+    protected bool $valueIndexed = false;
+
     /**
      * Set the value.
      *
      * @param Indexish<Tk, Tv> $value
      */
     final public function __construct(Indexish<Tk, Tv> $value = Map {}) {
+        $this->refs = new RefCount();
         $this->write($value);
     }
 
     /**
      * Allow methods on the base Map class to be called programmatically.
+     * Only methods defined in the `$chainable` table can be called.
      *
      * @param string $method
      * @param array<mixed> $args
@@ -93,46 +122,50 @@ class HashMap<Tk, Tv> implements
      * @throws \Titon\Type\Exception\MissingMethodException
      */
     public function __call(string $method, array<mixed> $args): HashMap<Tk, Tv> {
-        $map = $this->value();
-
-        if (method_exists($map, $method)) {
-
-            // Chain the method call
-            if (in_array($method, $this->chainable)) {
-
-                // UNSAFE
-                // Since `inst_meth()` requires literal strings and we are passing variables
-                call_user_func_array(inst_meth($map, $method), $args);
 
-                return $this;
+        // Chain the method call
+        if (static::$chainable->contains($method)) {
 
-            // Return a new instance for immutability
-            } else if (in_array($method, $this->immutable)) {
+            // Copy the map first if it is shared with other maps
+            $map = $this->detach();
 
-                // Clone the map so we don't interfere with references
-                $clonedList = $map->toMap();
+            // UNSAFE
+            // Since `inst_meth()` requires literal strings and we are passing variables
+            call_user_func_array(inst_meth($map, $method), $args);
 
-                // UNSAFE
-                // Since `inst_meth()` requires literal strings and we are passing variables
-                $mutatedList = call_user_func_array(inst_meth($clonedList, $method), $args);
+            $this->invalidate();
 
-                // Some methods return void/null so use the cloned list
-                if ($mutatedList === null) {
-                    $mutatedList = $clonedList;
-                }
-
-                return new static($mutatedList);
-            }
+            return $this;
         }
 
         throw new MissingMethodException(sprintf('Method "%s" does not exist or is not callable for %s', $method, static::class));
     }
 
     /**
-     * Clone the internal map so references aren't shared.
+     * Share the internal map with the clone. The map will be copied once either map is modified.
      */
     public function __clone(): void {
-        $this->value = $this->value->toMap();
+        $this->refs->acquire();
+
+        // Indexes are updated in place so they can't be shared
+        $this->invalidate();
+    }
+
+    /**
+     * Release the internal map once the map is no longer used, so that other wrappers sharing it can modify it without copying.
+     */
+    public function __destruct(): void {
+        $this->refs->release();
+    }
+
+    /**
+     * Alias for Map::add(). Add a key-value pair to the map.
+     *
+     * @param Pair<Tk, Tv> $value
+     * @return $this
+     */
+    public function add(Pair<Tk, Tv> $value): this {
+        return $this->set($value[0], $value[1]);
     }
 
     /**
@@ -142,26 +175,72 @@ class HashMap<Tk, Tv> implements
      * @return Tv
      */
     public function at(Tk $key): Tv {
-        return $this->value()->at($key);
+        return $this->value->at($key);
+    }
+
+    /**
+     * Return the average of all values in the map, or 0 if the map is empty.
+     * The values are expected to be numeric.
+     *
+     * @return float
+     */
+    public function average(): float {
+        $count = $this->count();
+
+        if ($count === 0) {
+            return 0.0;
+        }
+
+        return (float) $this->sum() / $count;
+    }
+
+    /**
+     * Return the last K entries that a sort with the callback would produce, in sorted order with keys preserved.
+     * Uses a bounded heap, so only K entries are held and sorted, at O(n log k).
+     *
+     * @param int $k
+     * @param (function(Tv, Tv): int) $callback
+     * @return \Titon\Type\HashMap<Tk, Tv>
+     */
+    public function bottomK(int $k, ?(function(Tv, Tv): int) $callback = null): HashMap<Tk, Tv> {
+        $callback = $callback ?: Heap::natural();
+        $entries = $this->select($k, ($a, $b) ==> $callback($b, $a));
+        $entries->reverse();
+
+        return $this->wrap(Map::fromItems($entries));
     }
 
     /**
-     * Split a map into multiple chunked maps.
+     * Split a map into multiple chunks. Each chunk is a read-only slice view over the map,
+     * so entries are not copied until a chunk is converted.
      *
      * @param int $size
-     * @return \Titon\Type\ArrayList<HashMap<Tk, Tv>>
+     * @return \Titon\Type\ArrayList<MapSlice<Tk, Tv>>
      */
-    public function chunk(int $size): ArrayList<HashMap<Tk, Tv>> {
-        $chunks = array_chunk($this->toArray(), $size, true);
+    public function chunk(int $size): ArrayList<MapSlice<Tk, Tv>> {
         $list = Vector {};
 
-        foreach ($chunks as $chunk) {
-            $list[] = new static($chunk);
+        foreach ($this->chunks($size) as $chunk) {
+            $list[] = $chunk;
         }
 
         return new ArrayList($list);
     }
 
+    /**
+     * Return a generator that yields one chunk (a read-only slice view) at a time.
+     *
+     * @param int $size
+     * @return Iterator<\Titon\Type\MapSlice<Tk, Tv>>
+     */
+    public function chunks(int $size): Iterator<MapSlice<Tk, Tv>> {
+        invariant($size > 0, 'Chunk size must be greater than 0');
+
+        for ($offset = 0, $count = $this->count(); $offset < $count; $offset += $size) {
+            yield $this->slice($offset, $size);
+        }
+    }
+
     /**
      * Removes all empty, null, and false values.
      *
@@ -180,16 +259,17 @@ class HashMap<Tk, Tv> implements
      * @return \Titon\Type\HashMap<Tk, Tv>
      */
     public function concat(HashMap<Tk, Tv> $value, bool $append = true): HashMap<Tk, Tv> {
-        $oldMap = $this->toMap();
-        $newMap = $value->toMap();
+        if ($value->isEmpty()) {
+            return clone $this;
+        }
 
         if ($append) {
-            $map = $oldMap->addAll($newMap->items());
+            $map = $this->toMap()->addAll($value->value->items());
         } else {
-            $map = $newMap->addAll($oldMap->items());
+            $map = $value->toMap()->addAll($this->value->items());
         }
 
-        return new static($map);
+        return $this->wrap($map);
     }
 
     /**
@@ -199,7 +279,11 @@ class HashMap<Tk, Tv> implements
      * @return bool
      */
     public function contains(Tv $value): bool {
-        return in_array($value, $this->value(), true);
+        if ($this->valueIndexed && (is_int($value) || is_string($value))) {
+            return $this->valueIndex()->containsKey($value);
+        }
+
+        return in_array($value, $this->value, true);
     }
 
     /**
@@ -208,7 +292,24 @@ class HashMap<Tk, Tv> implements
      * @return int
      */
     public function count(): int {
-        return $this->value()->count();
+        return $this->value->count();
+    }
+
+    /**
+     * Count how many values return the same key from the callback, in a single pass.
+     *
+     * @param (function(Tv): Tu) $callback
+     * @return \Titon\Type\HashMap<Tu, int>
+     */
+    public function countBy<Tu>((function(Tv): Tu) $callback): HashMap<Tu, int> {
+        $counts = Map {};
+
+        foreach ($this->value as $value) {
+            $key = $callback($value);
+            $counts[$key] = $counts->contains($key) ? $counts[$key] + 1 : 1;
+        }
+
+        return (new HashMap())->adopt($counts);
     }
 
     /**
@@ -219,7 +320,24 @@ class HashMap<Tk, Tv> implements
      * @return int
      */
     public function depth(): int {
-        return Col::depth($this->value());
+        return Col::depth($this->value);
+    }
+
+    /**
+     * Return the items whose key does not exist in the other traversable.
+     * The other keys are hashed once, so the difference is a single pass over each side.
+     *
+     * @param KeyedTraversable<Tk, mixed> $other
+     * @return \Titon\Type\HashMap<Tk, Tv>
+     */
+    public function diffByKey(KeyedTraversable<Tk, mixed> $other): HashMap<Tk, Tv> {
+        $keys = Map {};
+
+        foreach ($other as $key => $value) {
+            $keys[$key] = true;
+        }
+
+        return $this->filterWithKey(($key, $value) ==> !$keys->contains($key));
     }
 
     /**
@@ -231,7 +349,14 @@ class HashMap<Tk, Tv> implements
      * @return \Titon\Type\HashMap<Tk, Tv>
      */
     public function each((function(Tk, Tv): Tv) $callback): HashMap<Tk, Tv> {
-        return new static(Col::each($this->value(), $callback));
+        $start = Profiler::$enabled ? microtime(true) : 0.0;
+        $value = Col::each($this->value, $callback);
+
+        if ($start > 0.0) {
+            Profiler::record(static::class, __FUNCTION__, $this->count(), 0, $this->count(), $start);
+        }
+
+        return new static($value);
     }
 
     /**
@@ -241,15 +366,19 @@ class HashMap<Tk, Tv> implements
      * @return \Titon\Type\HashMap<Tk, Tv>
      */
     public function erase(Tv $erase): HashMap<Tk, Tv> {
+        if ($this->valueIndexed && !$this->contains($erase)) {
+            return clone $this;
+        }
+
         $map = Map {};
 
-        foreach ($this->value() as $key => $value) {
+        foreach ($this->value as $key => $value) {
             if ($value !== $erase) {
                 $map[$key] = $value;
             }
         }
 
-        return new static($map);
+        return $this->wrap($map);
     }
 
     /**
@@ -261,22 +390,50 @@ class HashMap<Tk, Tv> implements
      * @return bool
      */
     public function every((function(Tk, Tv): bool) $callback): bool {
-        return Col::every($this->value(), $callback);
+        return Col::every($this->value, $callback);
     }
 
     /**
-     * Return the first item in the map.
+     * Alias for Map::filter(). Return a new HashMap with all values that satisfy the callback.
      *
-     * @return ?Tv
+     * @param (function(Tv): bool) $callback
+     * @return \Titon\Type\HashMap<Tk, Tv>
      */
-    public function first(): ?Tv {
-        $keys = $this->keys();
+    public function filter((function(Tv): bool) $callback): HashMap<Tk, Tv> {
+        $start = Profiler::$enabled ? microtime(true) : 0.0;
+        $value = $this->value->filter($callback);
 
-        if ($keys->containsKey(0)) {
-            return $this->get($keys[0]);
+        if ($start > 0.0) {
+            Profiler::record(static::class, __FUNCTION__, $value->count(), 0, $this->count(), $start);
         }
 
-        return null;
+        return $this->wrap($value);
+    }
+
+    /**
+     * Alias for Map::filterWithKey(). Return a new HashMap with all values that satisfy the callback.
+     *
+     * @param (function(Tk, Tv): bool) $callback
+     * @return \Titon\Type\HashMap<Tk, Tv>
+     */
+    public function filterWithKey((function(Tk, Tv): bool) $callback): HashMap<Tk, Tv> {
+        $start = Profiler::$enabled ? microtime(true) : 0.0;
+        $value = $this->value->filterWithKey($callback);
+
+        if ($start > 0.0) {
+            Profiler::record(static::class, __FUNCTION__, $value->count(), 0, $this->count(), $start);
+        }
+
+        return $this->wrap($value);
+    }
+
+    /**
+     * Return the first item in the map.
+     *
+     * @return ?Tv
+     */
+    public function first(): ?Tv {
+        return $this->value->firstValue();
     }
 
     /**
@@ -290,6 +447,36 @@ class HashMap<Tk, Tv> implements
         return $this;
     }
 
+    /**
+     * Decode a map from the compact binary format created by `toBinary()`.
+     *
+     * @uses Titon\Type\Binary
+     *
+     * @param string $data
+     * @return $this
+     * @throws \Titon\Type\Exception\InvalidBinaryException
+     */
+    public static function fromBinary(string $data): this {
+        $value = Binary::decode($data);
+
+        if ($value instanceof static) {
+            return $value;
+        }
+
+        throw new InvalidBinaryException(sprintf('Binary data does not contain a %s', static::class));
+    }
+
+    /**
+     * Create a map that uses the map as its internal value without copying it.
+     * The map should not be referenced or modified outside of the wrapper.
+     *
+     * @param Map<Tk, Tv> $value
+     * @return $this
+     */
+    public static function fromMap(Map<Tk, Tv> $value): this {
+        return (new static())->adopt($value);
+    }
+
     /**
      * Alias for Map::get(). Will return the value at the specified index or return null.
      *
@@ -297,7 +484,7 @@ class HashMap<Tk, Tv> implements
      * @return ?Tv
      */
     public function get(Tk $key): ?Tv {
-        return $this->value()->get($key);
+        return $this->value->get($key);
     }
 
     /**
@@ -306,7 +493,7 @@ class HashMap<Tk, Tv> implements
      * @return KeyedIterator<Tk, Tv>
      */
     public function getIterator(): KeyedIterator<Tk, Tv> {
-        return $this->value()->getIterator();
+        return $this->value->getIterator();
     }
 
     /**
@@ -316,19 +503,26 @@ class HashMap<Tk, Tv> implements
      * @return \Titon\Type\HashMap<Tu, HashMap<Tk, Tv>>
      */
     public function groupBy<Tu>((function(Tv, Tk): Tu) $callback): HashMap<Tu, HashMap<Tk, Tv>> {
-        $grouped = Map {};
+        $groups = Map {};
 
-        foreach ($this->value() as $key => $value) {
-            $index = call_user_func_array($callback, [$value, $key]);
+        // Build raw maps first and only wrap each group once at the end
+        foreach ($this->value as $key => $value) {
+            $index = $callback($value, $key);
 
-            if (!$grouped->contains($index)) {
-                $grouped[$index] = new static();
+            if ($groups->contains($index)) {
+                $groups[$index][$key] = $value;
+            } else {
+                $groups[$index] = Map {$key => $value};
             }
+        }
+
+        $grouped = Map {};
 
-            $grouped[$index]->set($key, $value);
+        foreach ($groups as $index => $group) {
+            $grouped[$index] = (new HashMap())->adopt($group);
         }
 
-        return new static($grouped);
+        return (new HashMap())->adopt($grouped);
     }
 
     /**
@@ -338,7 +532,18 @@ class HashMap<Tk, Tv> implements
      * @return bool
      */
     public function has(Tk $key): bool {
-        return $this->value()->containsKey($key);
+        return $this->value->containsKey($key);
+    }
+
+    /**
+     * Return a HashMap of values keyed by the return value of the callback.
+     * If multiple values return the same key, the last value is kept.
+     *
+     * @param (function(Tv): Tu) $callback
+     * @return \Titon\Type\HashMap<Tu, Tv>
+     */
+    public function indexBy<Tu>((function(Tv): Tu) $callback): HashMap<Tu, Tv> {
+        return $this->reorder(($value, $key) ==> $callback($value));
     }
 
     /**
@@ -349,17 +554,30 @@ class HashMap<Tk, Tv> implements
      * @return int
      */
     public function indexOf(Tk $key): int {
-        $count = 0;
+        $position = $this->positionIndex()->get($key);
 
-        foreach ($this->value() as $index => $value) {
-            if ($index === $key) {
-                return $count;
-            }
+        if ($position === null) {
+            return -1;
+        }
+
+        return $position;
+    }
+
+    /**
+     * Return the items whose key also exists in the other traversable.
+     * The other keys are hashed once, so the intersection is a single pass over each side.
+     *
+     * @param KeyedTraversable<Tk, mixed> $other
+     * @return \Titon\Type\HashMap<Tk, Tv>
+     */
+    public function intersectByKey(KeyedTraversable<Tk, mixed> $other): HashMap<Tk, Tv> {
+        $keys = Map {};
 
-            ++$count;
+        foreach ($other as $key => $value) {
+            $keys[$key] = true;
         }
 
-        return -1;
+        return $this->filterWithKey(($key, $value) ==> $keys->contains($key));
     }
 
     /**
@@ -368,7 +586,26 @@ class HashMap<Tk, Tv> implements
      * @return bool
      */
     public function isEmpty(): bool {
-        return $this->value()->isEmpty();
+        return $this->value->isEmpty();
+    }
+
+    /**
+     * Return a lazy list of pairs for every value and other value whose keys from the callbacks match.
+     * The join is a hash join that is only executed once the lazy list is iterated.
+     *
+     * Pairs are in the order of the values, then the other values. If the order does not matter,
+     * set ordered to false to hash whichever side is smaller, in which case the order is unspecified.
+     *
+     * @uses Titon\Type\Join
+     *
+     * @param Traversable<Tr> $other
+     * @param (function(Tv): arraykey) $leftKey
+     * @param (function(Tr): arraykey) $rightKey
+     * @param bool $ordered
+     * @return \Titon\Type\LazyList<Pair<Tv, Tr>>
+     */
+    public function join<Tr>(Traversable<Tr> $other, (function(Tv): arraykey) $leftKey, (function(Tr): arraykey) $rightKey, bool $ordered = true): LazyList<Pair<Tv, Tr>> {
+        return new LazyList(new Join($this->value, $leftKey, $other, $rightKey, false, $ordered), Vector {}, $this->refs);
     }
 
     /**
@@ -380,6 +617,16 @@ class HashMap<Tk, Tv> implements
         return $this->toArray();
     }
 
+    /**
+     * Return the key at the specified position within the map, or null if out of bounds.
+     *
+     * @param int $position
+     * @return ?Tk
+     */
+    public function keyAt(int $position): ?Tk {
+        return $this->keyIndex()->get($position);
+    }
+
     /**
      * Return the key for the first item that matches the defined value.
      * If no items are found, then null is returned.
@@ -388,6 +635,10 @@ class HashMap<Tk, Tv> implements
      * @return Tk
      */
     public function keyOf(Tv $value): ?Tk {
+        if ($this->valueIndexed && (is_int($value) || is_string($value))) {
+            return $this->valueIndex()->get($value);
+        }
+
         foreach ($this->getIterator() as $key => $val) {
             if ($value === $val) {
                 return $key;
@@ -403,7 +654,7 @@ class HashMap<Tk, Tv> implements
      * @return Vector<Tk>
      */
     public function keys(): Vector<Tk> {
-        return $this->value()->keys();
+        return $this->value->keys();
     }
 
     /**
@@ -412,14 +663,22 @@ class HashMap<Tk, Tv> implements
      * @return ?Tv
      */
     public function last(): ?Tv {
-        $keys = $this->keys();
-        $count = $this->count();
-
-        if ($count > 0) {
-            return $this->get($keys[$count - 1]);
-        }
+        return $this->value->lastValue();
+    }
 
-        return null;
+    /**
+     * Return a lazy list of pairs for every value and other value whose keys from the callbacks match,
+     * and a pair with a null other value for every value without a match. Pairs are in the order of the values.
+     *
+     * @uses Titon\Type\Join
+     *
+     * @param Traversable<Tr> $other
+     * @param (function(Tv): arraykey) $leftKey
+     * @param (function(Tr): arraykey) $rightKey
+     * @return \Titon\Type\LazyList<Pair<Tv, ?Tr>>
+     */
+    public function leftJoin<Tr>(Traversable<Tr> $other, (function(Tv): arraykey) $leftKey, (function(Tr): arraykey) $rightKey): LazyList<Pair<Tv, ?Tr>> {
+        return new LazyList(new Join($this->value, $leftKey, $other, $rightKey, true), Vector {}, $this->refs);
     }
 
     /**
@@ -431,6 +690,63 @@ class HashMap<Tk, Tv> implements
         return $this->count();
     }
 
+    /**
+     * Alias for Map::map(). Return a new HashMap with every value transformed by the callback.
+     *
+     * @param (function(Tv): Tu) $callback
+     * @return \Titon\Type\HashMap<Tk, Tu>
+     */
+    public function map<Tu>((function(Tv): Tu) $callback): HashMap<Tk, Tu> {
+        // UNSAFE
+        // Since `wrap()` is bound to the current value type
+        $start = Profiler::$enabled ? microtime(true) : 0.0;
+        $value = $this->value->map($callback);
+
+        if ($start > 0.0) {
+            Profiler::record(static::class, __FUNCTION__, $value->count(), 0, $this->count(), $start);
+        }
+
+        return $this->wrap($value);
+    }
+
+    /**
+     * Alias for Map::mapWithKey(). Return a new HashMap with every value transformed by the callback.
+     *
+     * @param (function(Tk, Tv): Tu) $callback
+     * @return \Titon\Type\HashMap<Tk, Tu>
+     */
+    public function mapWithKey<Tu>((function(Tk, Tv): Tu) $callback): HashMap<Tk, Tu> {
+        // UNSAFE
+        // Since `wrap()` is bound to the current value type
+        $start = Profiler::$enabled ? microtime(true) : 0.0;
+        $value = $this->value->mapWithKey($callback);
+
+        if ($start > 0.0) {
+            Profiler::record(static::class, __FUNCTION__, $value->count(), 0, $this->count(), $start);
+        }
+
+        return $this->wrap($value);
+    }
+
+    /**
+     * Return the largest value in the map, or null if the map is empty.
+     *
+     * @return ?Tv
+     */
+    public function max(): ?Tv {
+        $max = null;
+        $found = false;
+
+        foreach ($this->value as $value) {
+            if (!$found || $value > $max) {
+                $max = $value;
+                $found = true;
+            }
+        }
+
+        return $max;
+    }
+
     /**
      * Merge two HashMaps together with values from the second map overwriting the first map.
      *
@@ -438,7 +754,26 @@ class HashMap<Tk, Tv> implements
      * @return \Titon\Type\HashMap<Tk, Tv>
      */
     public function merge(HashMap<Tk, Tv> $value): HashMap<Tk, Tv> {
-        return new static($this->toMap()->setAll($value->toMap()));
+        return $this->wrap($this->toMap()->setAll($value->value));
+    }
+
+    /**
+     * Return the smallest value in the map, or null if the map is empty.
+     *
+     * @return ?Tv
+     */
+    public function min(): ?Tv {
+        $min = null;
+        $found = false;
+
+        foreach ($this->value as $value) {
+            if (!$found || $value < $min) {
+                $min = $value;
+                $found = true;
+            }
+        }
+
+        return $min;
     }
 
     /**
@@ -450,13 +785,54 @@ class HashMap<Tk, Tv> implements
     public function pluck<Tu>((function(Tv, Tk): Tu) $callback): Vector<Tu> {
         $list = Vector {};
 
-        foreach ($this->value() as $key => $value) {
-            $list[] = call_user_func_array($callback, [$value, $key]);
+        foreach ($this->value as $key => $value) {
+            $list[] = $callback($value, $key);
         }
 
         return $list;
     }
 
+    /**
+     * Return the product of all values in the map, or 1 if the map is empty.
+     * The values are expected to be numeric.
+     *
+     * @return num
+     */
+    public function product(): num {
+        // UNSAFE
+        // Values are not constrained to numbers
+        $product = 1;
+
+        foreach ($this->value as $value) {
+            $product *= $value;
+        }
+
+        return $product;
+    }
+
+    /**
+     * Reduce the map to a single value by passing the accumulated value and each value to the callback,
+     * starting with the initial value.
+     *
+     * @param (function(Tu, Tv): Tu) $callback
+     * @param Tu $initial
+     * @return Tu
+     */
+    public function reduce<Tu>((function(Tu, Tv): Tu) $callback, Tu $initial): Tu {
+        $start = Profiler::$enabled ? microtime(true) : 0.0;
+        $result = $initial;
+
+        foreach ($this->value as $value) {
+            $result = $callback($result, $value);
+        }
+
+        if ($start > 0.0) {
+            Profiler::record(static::class, __FUNCTION__, 0, 0, $this->count(), $start);
+        }
+
+        return $result;
+    }
+
     /**
      * Remove an item at the specific index. This will reorder indices.
      *
@@ -464,7 +840,8 @@ class HashMap<Tk, Tv> implements
      * @return $this
      */
     public function remove(Tk $key): this {
-        $this->value()->removeKey($key);
+        $this->detach()->removeKey($key);
+        $this->invalidate();
 
         return $this;
     }
@@ -476,13 +853,13 @@ class HashMap<Tk, Tv> implements
      * @return \Titon\Type\HashMap<Tu, Tv>
      */
     public function reorder<Tu>((function(Tv, Tk): Tu) $callback): HashMap<Tu, Tv> {
-        $map = new static();
+        $map = Map {};
 
-        foreach ($this->value() as $key => $item) {
-            $map->set(call_user_func_array($callback, [$item, $key]), $item);
+        foreach ($this->value as $key => $item) {
+            $map[$callback($item, $key)] = $item;
         }
 
-        return $map;
+        return (new HashMap())->adopt($map);
     }
 
     /**
@@ -500,7 +877,30 @@ class HashMap<Tk, Tv> implements
      * @return string
      */
     public function serialize(): string {
-        return serialize($this->value());
+        return serialize($this->value);
+    }
+
+    /**
+     * Alias for Map::set(). Set the value for the specified key.
+     *
+     * @param Tk $key
+     * @param Tv $value
+     * @return $this
+     */
+    public function set(Tk $key, Tv $value): this {
+        $map = $this->detach();
+
+        if ($map->containsKey($key)) {
+            $this->reindexValue($key, $map[$key], $value);
+
+        // New keys are appended, so the indexes can be updated in place
+        } else {
+            $this->appendIndex($key, $value);
+        }
+
+        $map->set($key, $value);
+
+        return $this;
     }
 
     /**
@@ -515,6 +915,22 @@ class HashMap<Tk, Tv> implements
         return new static($map);
     }
 
+    /**
+     * Return a read-only view over a positional range of the map. The entries are not copied,
+     * and any modifications to the map after slicing will not be reflected in the slice.
+     *
+     * @param int $offset
+     * @param int $length
+     * @return \Titon\Type\MapSlice<Tk, Tv>
+     */
+    public function slice(int $offset, ?int $length = null): MapSlice<Tk, Tv> {
+        if ($length === null) {
+            $length = $this->count() - $offset;
+        }
+
+        return new MapSlice($this->value, $this->keyIndex(), $offset, $length, $this->refs);
+    }
+
     /**
      * Returns true if at least one item in the map satisfies the provided testing function.
      *
@@ -524,7 +940,7 @@ class HashMap<Tk, Tv> implements
      * @return bool
      */
     public function some((function(Tk, Tv): bool) $callback): bool {
-        return Col::some($this->value(), $callback);
+        return Col::some($this->value, $callback);
     }
 
     /**
@@ -543,26 +959,109 @@ class HashMap<Tk, Tv> implements
             asort($map, $flags);
         }
 
-        return new static($map);
+        return $this->wrap($map);
     }
 
     /**
-     * Return the map as an array.
+     * Sort the items in the map by the value returned from the callback, while preserving keys.
+     * The callback is called once per item, instead of twice per comparison, which makes this faster
+     * than `sort()` when deriving the sort key is costly.
      *
-     * @return array<Tk, Tv>
+     * @param (function(Tv): mixed) $callback
+     * @param int $flags
+     * @return \Titon\Type\HashMap<Tk, Tv>
      */
-    public function toArray(): array<Tk, Tv> {
-        return $this->value()->toArray();
-    }
+    public function sortBy((function(Tv): mixed) $callback, int $flags = SORT_REGULAR): HashMap<Tk, Tv> {
+        $value = $this->value;
+        $keys = Map {};
 
-    /**
-     * Return the map as a JSON string.
-     *
-     * @param int $options
+        foreach ($value as $key => $item) {
+            $keys[$key] = $callback($item);
+        }
+
+        asort($keys, $flags);
+
+        $map = Map {};
+        $map->reserve($keys->count());
+
+        foreach ($keys as $key => $sortKey) {
+            $map[$key] = $value[$key];
+        }
+
+        return $this->wrap($map);
+    }
+
+    /**
+     * Return an iterator that yields the entries in sorted order on demand, using the callback or ascending order.
+     * Keys are preserved. The heap is built in O(n) and each entry costs O(log n) once requested,
+     * so stopping early avoids the cost of a full sort.
+     *
+     * @param (function(Tv, Tv): int) $callback
+     * @return KeyedIterator<Tk, Tv>
+     */
+    public function sorted(?(function(Tv, Tv): int) $callback = null): KeyedIterator<Tk, Tv> {
+        $callback = $callback ?: Heap::natural();
+        $heap = new Heap(($a, $b) ==> $callback($a[1], $b[1]), $this->value->items());
+
+        foreach ($heap->drain() as $entry) {
+            yield $entry[0] => $entry[1];
+        }
+    }
+
+    /**
+     * Return the sum of all values in the map, or 0 if the map is empty.
+     * The values are expected to be numeric.
+     *
+     * @return num
+     */
+    public function sum(): num {
+        // UNSAFE
+        // Values are not constrained to numbers
+        $sum = 0;
+
+        foreach ($this->value as $value) {
+            $sum += $value;
+        }
+
+        return $sum;
+    }
+
+    /**
+     * Return the map as an array.
+     *
+     * @return array<Tk, Tv>
+     */
+    public function toArray(): array<Tk, Tv> {
+        if (Profiler::$enabled) {
+            Profiler::record(static::class, __FUNCTION__, $this->count());
+        }
+
+        return $this->value->toArray();
+    }
+
+    /**
+     * Return the map encoded in a compact binary format, which is smaller and faster to decode than `serialize()`.
+     *
+     * @uses Titon\Type\Binary
+     *
+     * @return string
+     */
+    public function toBinary(): string {
+        return Binary::encode($this);
+    }
+
+    /**
+     * Return the map as a JSON string.
+     *
+     * @param int $options
      * @return string
      */
     public function toJson(int $options = 0): string {
-        return json_encode($this, $options);
+        $sink = new BufferSink();
+
+        $this->writeJson($sink, $options);
+
+        return $sink->toString();
     }
 
     /**
@@ -571,7 +1070,22 @@ class HashMap<Tk, Tv> implements
      * @return Map<Tk, Tv>
      */
     public function toMap(): Map<Tk, Tv> {
-        return $this->value()->toMap();
+        if (Profiler::$enabled) {
+            Profiler::record(static::class, __FUNCTION__, $this->count());
+        }
+
+        return $this->value->toMap();
+    }
+
+    /**
+     * Return the map as a persistent map, which supports cheap copies on set and remove.
+     *
+     * @return \Titon\Type\PersistentMap<Tk, Tv>
+     */
+    public function toPersistent(): PersistentMap<Tk, Tv> {
+        // UNSAFE
+        // Persistent maps require arraykey keys
+        return new PersistentMap($this->value);
     }
 
     /**
@@ -580,7 +1094,11 @@ class HashMap<Tk, Tv> implements
      * @return Vector<Tv>
      */
     public function toVector(): Vector<Tv> {
-        return $this->value()->toVector();
+        if (Profiler::$enabled) {
+            Profiler::record(static::class, __FUNCTION__, $this->count());
+        }
+
+        return $this->value->toVector();
     }
 
     /**
@@ -590,9 +1108,23 @@ class HashMap<Tk, Tv> implements
      * @return string
      */
     public function toXml(string $root = 'document'): string {
-        // UNSAFE
-        // The HashMap value is `Map<Tk, Tv>` while the XmlMap is `Map<string, mixed>`
-        return Xml::fromMap($root, $this->value())->toString();
+        $sink = new BufferSink();
+
+        $this->writeXml($sink, $root);
+
+        return $sink->toString();
+    }
+
+    /**
+     * Return the first K entries that a sort with the callback would produce, in sorted order with keys preserved.
+     * Uses a bounded heap, so only K entries are held and sorted, at O(n log k).
+     *
+     * @param int $k
+     * @param (function(Tv, Tv): int) $callback
+     * @return \Titon\Type\HashMap<Tk, Tv>
+     */
+    public function topK(int $k, ?(function(Tv, Tv): int) $callback = null): HashMap<Tk, Tv> {
+        return $this->wrap(Map::fromItems($this->select($k, $callback ?: Heap::natural())));
     }
 
     /**
@@ -601,26 +1133,166 @@ class HashMap<Tk, Tv> implements
      * @param string $value
      */
     public function unserialize(/* HH_FIXME[4032]: no type hint */ $value): void {
-        $this->write(unserialize($value));
+        $value = unserialize($value);
+
+        // The constructor is not called during unserialization
+        $this->refs = new RefCount();
+
+        // The unserialized map is not referenced elsewhere so it can be used directly
+        if ($value instanceof Map) {
+            $this->adopt($value);
+        } else {
+            $this->write($value);
+        }
+    }
+
+    /**
+     * Return the items of both maps, with items from the first map kept when both maps define a key.
+     * Unlike `merge()`, existing values are never overwritten.
+     *
+     * @param HashMap<Tk, Tv> $value
+     * @return \Titon\Type\HashMap<Tk, Tv>
+     */
+    public function union(HashMap<Tk, Tv> $value): HashMap<Tk, Tv> {
+        if ($value->isEmpty()) {
+            return clone $this;
+        }
+
+        $map = $this->toMap();
+
+        foreach ($value->value as $key => $item) {
+            if (!$map->contains($key)) {
+                $map[$key] = $item;
+            }
+        }
+
+        return $this->wrap($map);
     }
 
     /**
-     * Removes duplicate values from the map.
+     * Removes duplicate values from the map, keeping the key of the first occurrence of each value.
+     * Values are compared the same as `array_unique()` with the defined flags, unless strict is true,
+     * in which case the flags are ignored and values are compared by type and value (`1` and `"1"` are different).
+     *
+     * When strict, integers and strings are deduplicated by hash and other values by strict comparison, in a single pass.
+     * Otherwise, maps of values that can be hashed without changing how they compare (integers, or strings that
+     * are not numeric) are deduplicated by hash in a single pass instead of using `array_unique()`.
      *
      * @param int $flags
+     * @param bool $strict
      * @return \Titon\Type\HashMap<Tk, Tv>
      */
-    public function unique(int $flags = SORT_REGULAR): HashMap<Tk, Tv> {
+    public function unique(int $flags = SORT_REGULAR, bool $strict = false): HashMap<Tk, Tv> {
+        if ($strict) {
+            $seen = Set {};
+            $others = Vector {};
+            $map = Map {};
+
+            foreach ($this->value as $key => $value) {
+
+                // Values that can not be hashed are checked by strict comparison, the same as LazyList::unique()
+                if (is_int($value) || is_string($value)) {
+                    if ($seen->contains($value)) {
+                        continue;
+                    }
+
+                    $seen[] = $value;
+
+                } else {
+                    if (in_array($value, $others, true)) {
+                        continue;
+                    }
+
+                    $others[] = $value;
+                }
+
+                $map[$key] = $value;
+            }
+
+            return $this->wrap($map);
+        }
+
+        if ($flags === SORT_REGULAR) {
+            $seen = Set {};
+            $map = Map {};
+            $ints = false;
+            $strings = false;
+            $hashable = true;
+
+            foreach ($this->value as $key => $value) {
+                if (is_int($value)) {
+                    $ints = true;
+
+                // Numeric strings are compared as numbers
+                } else if (is_string($value) && !is_numeric($value)) {
+                    $strings = true;
+
+                } else {
+                    $hashable = false;
+                    break;
+                }
+
+                if (!$seen->contains($value)) {
+                    $seen[] = $value;
+                    $map[$key] = $value;
+                }
+            }
+
+            // Integers and strings can be loosely equal to each other
+            if ($hashable && !($ints && $strings)) {
+                return $this->wrap($map);
+            }
+        }
+
         return new static(array_unique($this->toArray(), $flags));
     }
 
     /**
-     * Return the raw value.
+     * Removes values that return the same key from the callback, keeping the first occurrence, in a single pass.
+     *
+     * @param (function(Tv): arraykey) $callback
+     * @return \Titon\Type\HashMap<Tk, Tv>
+     */
+    public function uniqueBy((function(Tv): arraykey) $callback): HashMap<Tk, Tv> {
+        $seen = Set {};
+        $map = Map {};
+
+        foreach ($this->value as $key => $value) {
+            $hash = $callback($value);
+
+            if (!$seen->contains($hash)) {
+                $seen[] = $hash;
+                $map[$key] = $value;
+            }
+        }
+
+        return $this->wrap($map);
+    }
+
+    /**
+     * Return a copy of the raw value, which can be modified without affecting this or any other map.
+     * Use `view()` to read the raw value without copying it.
      *
      * @return Map<Tk, Tv>
      */
     public function value(): Map<Tk, Tv> {
-        return $this->value;
+        return $this->value->toMap();
+    }
+
+    /**
+     * Return the value at the specified position within the map, or null if out of bounds.
+     *
+     * @param int $position
+     * @return ?Tv
+     */
+    public function valueAt(int $position): ?Tv {
+        $key = $this->keyAt($position);
+
+        if ($key === null) {
+            return null;
+        }
+
+        return $this->get($key);
     }
 
     /**
@@ -629,7 +1301,29 @@ class HashMap<Tk, Tv> implements
      * @return Vector<Tv>
      */
     public function values(): Vector<Tv> {
-        return $this->value()->values();
+        return $this->value->values();
+    }
+
+    /**
+     * Return the raw value without copying it. The map may be shared with other maps and is read only.
+     *
+     * @return ConstMap<Tk, Tv>
+     */
+    public function view(): ConstMap<Tk, Tv> {
+        return $this->value;
+    }
+
+    /**
+     * Enable the value index, which maps hashable (integer and string) values to their first key.
+     * Once enabled, `contains()`, `keyOf()`, and `erase()` resolve hashable values in constant time,
+     * while other values fall back to scanning the map.
+     *
+     * @return $this
+     */
+    public function withValueIndex(): this {
+        $this->valueIndexed = true;
+
+        return $this;
     }
 
     /**
@@ -639,9 +1333,251 @@ class HashMap<Tk, Tv> implements
      * @return $this
      */
     public function write(Indexish<Tk, Tv> $value): this {
-        $this->value = new Map($value);
+        $this->adopt(new Map($value));
+        $this->invalidate();
+
+        return $this;
+    }
+
+    /**
+     * Write the map as JSON to a sink, walking nested lists and maps in place instead of
+     * converting them to arrays first.
+     *
+     * @uses Titon\Type\Json\Writer
+     *
+     * @param \Titon\Type\Sink $sink
+     * @param int $options
+     * @return $this
+     */
+    public function writeJson(Sink $sink, int $options = 0): this {
+        (new JsonWriter($sink, $options))->write($this);
+
+        return $this;
+    }
+
+    /**
+     * Write the map as XML to a sink, without building an Element tree first.
+     *
+     * @uses Titon\Type\Xml\Writer
+     *
+     * @param \Titon\Type\Sink $sink
+     * @param string $root
+     * @return $this
+     */
+    public function writeXml(Sink $sink, string $root = 'document'): this {
+        // UNSAFE
+        // The HashMap value is `Map<Tk, Tv>` while the XmlMap is `Map<string, mixed>`
+        (new XmlWriter($sink))->writeMap($root, $this->value);
+
+        return $this;
+    }
+
+    /**
+     * Use the map as the internal value without copying it.
+     * The map should not be referenced or modified outside of this map.
+     *
+     * @param Map<Tk, Tv> $value
+     * @return $this
+     */
+    protected function adopt(Map<Tk, Tv> $value): this {
+        if ($this->refs->isShared()) {
+            $this->refs->release();
+            $this->refs = new RefCount();
+        }
+
+        $this->value = $value;
 
         return $this;
     }
 
+    /**
+     * Update the indexes for a key and value that are about to be appended to the map.
+     *
+     * @param Tk $key
+     * @param Tv $value
+     */
+    protected function appendIndex(Tk $key, Tv $value): void {
+        $keys = $this->keyIndex;
+        $positions = $this->positionIndex;
+        $values = $this->valueIndex;
+
+        if ($keys !== null) {
+            $keys[] = $key;
+        }
+
+        if ($positions !== null) {
+            $positions[$key] = $this->count();
+        }
+
+        if ($values !== null && (is_int($value) || is_string($value)) && !$values->containsKey($value)) {
+            $values[$value] = $key;
+        }
+    }
+
+    /**
+     * Copy the internal map if it is shared with other maps, so that it can be safely modified.
+     *
+     * @return Map<Tk, Tv>
+     */
+    protected function detach(): Map<Tk, Tv> {
+        if ($this->refs->isShared()) {
+            if (Profiler::$enabled) {
+                Profiler::record(static::class, Profiler::caller(), $this->value->count());
+            }
+
+            $this->adopt($this->value->toMap());
+        }
+
+        return $this->value;
+    }
+
+    /**
+     * Reset all lazily built indexes. Should be called after the map has been modified.
+     */
+    protected function invalidate(): void {
+        $this->keyIndex = null;
+        $this->positionIndex = null;
+        $this->valueIndex = null;
+    }
+
+    /**
+     * Return the list of keys in insertion order, building it if it does not exist.
+     *
+     * @return Vector<Tk>
+     */
+    protected function keyIndex(): Vector<Tk> {
+        $keys = $this->keyIndex;
+
+        if ($keys === null) {
+            $keys = $this->value->keys();
+            $this->keyIndex = $keys;
+        }
+
+        return $keys;
+    }
+
+    /**
+     * Return the mapping of keys to positions, building it if it does not exist.
+     *
+     * @return Map<Tk, int>
+     */
+    protected function positionIndex(): Map<Tk, int> {
+        $positions = $this->positionIndex;
+
+        if ($positions === null) {
+            $positions = Map {};
+            $position = 0;
+
+            foreach ($this->value as $key => $value) {
+                $positions[$key] = $position++;
+            }
+
+            $this->positionIndex = $positions;
+        }
+
+        return $positions;
+    }
+
+    /**
+     * Update the value index after the value for an existing key has been replaced.
+     *
+     * @param Tk $key
+     * @param Tv $previous
+     * @param Tv $value
+     */
+    protected function reindexValue(Tk $key, Tv $previous, Tv $value): void {
+        $values = $this->valueIndex;
+
+        if ($values === null || $previous === $value) {
+            return;
+        }
+
+        // The replaced value may appear under a later key, which can only be found by rebuilding
+        if ((is_int($previous) || is_string($previous)) && $values->get($previous) === $key) {
+            $this->valueIndex = null;
+
+            return;
+        }
+
+        if (is_int($value) || is_string($value)) {
+
+            // The value already exists under another key, but which one comes first is unknown
+            if ($values->containsKey($value)) {
+                $this->valueIndex = null;
+            } else {
+                $values[$value] = $key;
+            }
+        }
+    }
+
+    /**
+     * Select the first K entries in the order of the callback, by keeping the best K entries seen so far
+     * in a heap whose top is the worst of them. The entries are returned in sorted order.
+     *
+     * @param int $k
+     * @param (function(Tv, Tv): int) $callback
+     * @return Vector<Pair<Tk, Tv>>
+     */
+    protected function select(int $k, (function(Tv, Tv): int) $callback): Vector<Pair<Tk, Tv>> {
+        $entries = Vector {};
+
+        if ($k <= 0) {
+            return $entries;
+        }
+
+        $heap = new Heap(($a, $b) ==> $callback($b[1], $a[1]));
+
+        foreach ($this->value as $key => $value) {
+            if ($heap->count() < $k) {
+                $heap->push(Pair {$key, $value});
+
+            // Replace the worst of the selected entries
+            } else if ($callback($value, $heap->top()[1]) < 0) {
+                $heap->replace(Pair {$key, $value});
+            }
+        }
+
+        // The heap yields the worst entry first
+        foreach ($heap->drain() as $entry) {
+            $entries[] = $entry;
+        }
+
+        $entries->reverse();
+
+        return $entries;
+    }
+
+    /**
+     * Return the value index, building it if it does not exist.
+     *
+     * @return Map<arraykey, Tk>
+     */
+    protected function valueIndex(): Map<arraykey, Tk> {
+        $values = $this->valueIndex;
+
+        if ($values === null) {
+            $values = Map {};
+
+            foreach ($this->value as $key => $value) {
+                if ((is_int($value) || is_string($value)) && !$values->containsKey($value)) {
+                    $values[$value] = $key;
+                }
+            }
+
+            $this->valueIndex = $values;
+        }
+
+        return $values;
+    }
+
+    /**
+     * Return a new map that uses the map as its internal value without copying it.
+     *
+     * @param Map<Tk, Tv> $value
+     * @return \Titon\Type\HashMap<Tk, Tv>
+     */
+    protected function wrap(Map<Tk, Tv> $value): HashMap<Tk, Tv> {
+        return (new static())->adopt($value);
+    }
+
 }
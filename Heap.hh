@@ -0,0 +1,248 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+use \Countable;
+
+/**
+ * The Heap is a binary heap backed by a vector, ordered by a comparator. The item that the comparator
+ * sorts first is always at the top, and can be removed in O(log n). It is used for partial sorting,
+ * like selecting the top K items, or yielding items in sorted order without sorting them all upfront.
+ *
+ * @package Titon\Type
+ */
+class Heap<T> implements Countable {
+
+    /**
+     * Comparator that returns a negative number if the first item should be ordered before the second.
+     *
+     * @var (function(T, T): int)
+     */
+    protected (function(T, T): int) $comparator;
+
+    /**
+     * Items in heap order.
+     *
+     * @var Vector<T>
+     */
+    protected Vector<T> $items = Vector {};
+
+    /**
+     * Set the comparator and build the heap from a list of items in O(n).
+     * If no comparator is defined, items are ordered in ascending order.
+     *
+     * @param (function(T, T): int) $comparator
+     * @param Traversable<T> $items
+     */
+    public function __construct(?(function(T, T): int) $comparator = null, Traversable<T> $items = Vector {}) {
+        $this->comparator = $comparator ?: static::natural();
+
+        foreach ($items as $item) {
+            $this->items[] = $item;
+        }
+
+        for ($i = (int) ($this->items->count() / 2) - 1; $i >= 0; $i--) {
+            $this->siftDown($i);
+        }
+    }
+
+    /**
+     * Return a comparator that orders items in ascending order using the standard comparison operators.
+     *
+     * @return (function(Tn, Tn): int)
+     */
+    public static function natural<Tn>(): (function(Tn, Tn): int) {
+        return ($a, $b) ==> ($a == $b) ? 0 : (($a < $b) ? -1 : 1);
+    }
+
+    /**
+     * Return the number of items in the heap.
+     *
+     * @return int
+     */
+    public function count(): int {
+        return $this->items->count();
+    }
+
+    /**
+     * Remove and yield every item in order, emptying the heap. Each item is only removed once it is requested.
+     *
+     * @return Iterator<T>
+     */
+    public function drain(): Iterator<T> {
+        while (!$this->items->isEmpty()) {
+            yield $this->removeTop();
+        }
+    }
+
+    /**
+     * Return true if the heap is empty.
+     *
+     * @return bool
+     */
+    public function isEmpty(): bool {
+        return $this->items->isEmpty();
+    }
+
+    /**
+     * Return the top item without removing it, or null if the heap is empty.
+     *
+     * @return ?T
+     */
+    public function peek(): ?T {
+        return $this->items->get(0);
+    }
+
+    /**
+     * Remove and return the top item, or null if the heap is empty.
+     *
+     * @return ?T
+     */
+    public function pop(): ?T {
+        if ($this->items->isEmpty()) {
+            return null;
+        }
+
+        return $this->removeTop();
+    }
+
+    /**
+     * Add an item to the heap.
+     *
+     * @param T $item
+     * @return $this
+     */
+    public function push(T $item): this {
+        $this->items[] = $item;
+
+        $this->siftUp($this->items->count() - 1);
+
+        return $this;
+    }
+
+    /**
+     * Remove the top item and add a new item in a single sift, returning the removed item.
+     * If the heap is empty, the item is added and null is returned.
+     *
+     * @param T $item
+     * @return ?T
+     */
+    public function replace(T $item): ?T {
+        $items = $this->items;
+
+        if ($items->isEmpty()) {
+            $this->push($item);
+
+            return null;
+        }
+
+        $top = $items[0];
+        $items[0] = $item;
+
+        $this->siftDown(0);
+
+        return $top;
+    }
+
+    /**
+     * Return the items as a vector, in heap order (not sorted).
+     *
+     * @return Vector<T>
+     */
+    public function toVector(): Vector<T> {
+        return $this->items->toVector();
+    }
+
+    /**
+     * Return the top item without removing it. Throws an exception if the heap is empty.
+     *
+     * @return T
+     * @throws \OutOfBoundsException
+     */
+    public function top(): T {
+        return $this->items->at(0);
+    }
+
+    /**
+     * Remove the top item from a non-empty heap and restore the heap order.
+     *
+     * @return T
+     */
+    protected function removeTop(): T {
+        $items = $this->items;
+        $top = $items[0];
+        $last = $items->pop();
+
+        if (!$items->isEmpty()) {
+            $items[0] = $last;
+
+            $this->siftDown(0);
+        }
+
+        return $top;
+    }
+
+    /**
+     * Move the item at the index down the heap until both of its children are ordered after it.
+     *
+     * @param int $index
+     */
+    protected function siftDown(int $index): void {
+        $items = $this->items;
+        $compare = $this->comparator;
+        $count = $items->count();
+        $item = $items[$index];
+
+        while (true) {
+            $child = ($index * 2) + 1;
+
+            if ($child >= $count) {
+                break;
+            }
+
+            // Use the child that is ordered first
+            if (($child + 1) < $count && $compare($items[$child + 1], $items[$child]) < 0) {
+                $child++;
+            }
+
+            if ($compare($items[$child], $item) >= 0) {
+                break;
+            }
+
+            $items[$index] = $items[$child];
+            $index = $child;
+        }
+
+        $items[$index] = $item;
+    }
+
+    /**
+     * Move the item at the index up the heap until its parent is ordered before it.
+     *
+     * @param int $index
+     */
+    protected function siftUp(int $index): void {
+        $items = $this->items;
+        $compare = $this->comparator;
+        $item = $items[$index];
+
+        while ($index > 0) {
+            $parent = (int) (($index - 1) / 2);
+
+            if ($compare($item, $items[$parent]) >= 0) {
+                break;
+            }
+
+            $items[$index] = $items[$parent];
+            $index = $parent;
+        }
+
+        $items[$index] = $item;
+    }
+
+}
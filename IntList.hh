@@ -0,0 +1,52 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+/**
+ * The IntList is an extension of the NumericList for lists of integers, like lists of IDs.
+ * Since integers are hashable, lookups use the value index by default and duplicates are removed by hash.
+ *
+ * @package Titon\Type
+ */
+class IntList extends NumericList<int> {
+
+    /**
+     * Integer lookups always use the value index.
+     *
+     * @var bool
+     */
+    protected bool $valueIndexed = true;
+
+    /**
+     * Return the sum of all integers.
+     *
+     * @return int
+     */
+    public function sum(): int {
+        $sum = 0;
+
+        foreach ($this->value as $value) {
+            $sum += $value;
+        }
+
+        return $sum;
+    }
+
+    /**
+     * Removes duplicate integers from the list in a single pass, keeping the first occurrence.
+     * The flags are ignored as integers are always compared by value.
+     *
+     * @param int $flags
+     * @param bool $strict
+     * @return \Titon\Type\ArrayList<int>
+     */
+    public function unique(int $flags = SORT_REGULAR, bool $strict = false): ArrayList<int> {
+        return $this->wrap((new Set($this->value))->toVector());
+    }
+
+}
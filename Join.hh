@@ -0,0 +1,198 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+use \Countable;
+use \IteratorAggregate;
+
+/**
+ * The Join is a deferred hash join between two traversables. Each side defines a callback that returns
+ * the key to join on, and a pair of the left and right values is produced for every matching key.
+ *
+ * When iterated, a hash table of keys is built for one side and the other side is streamed through it,
+ * so a join costs O(n + m) instead of the O(n * m) of nested loops, and only the hashed side is held in memory.
+ *
+ * Ordered and outer joins always hash the right side and stream the left side, so pairs are produced in the order
+ * of the left values, and each left value's matches in the order of the right values. An outer join also produces
+ * a pair with a null right value for each left value without a match, in place of its matches.
+ *
+ * Unordered inner joins hash the smaller side instead, which uses less memory when the left side is smaller.
+ * The order of their pairs is unspecified and may change with the sizes of the sides.
+ *
+ * Since the sides are not copied, changes to either side are reflected by the next iteration.
+ *
+ * @package Titon\Type
+ */
+class Join<Tl, Tr> implements IteratorAggregate<Pair<Tl, ?Tr>> {
+
+    /**
+     * The left side of the join.
+     *
+     * @var Traversable<Tl>
+     */
+    protected Traversable<Tl> $left;
+
+    /**
+     * Callback that returns the join key for a left value.
+     *
+     * @var (function(Tl): arraykey)
+     */
+    protected (function(Tl): arraykey) $leftKey;
+
+    /**
+     * Whether pairs must be produced in the order of the left side.
+     *
+     * @var bool
+     */
+    protected bool $ordered;
+
+    /**
+     * Whether left values without a match should be produced.
+     *
+     * @var bool
+     */
+    protected bool $outer;
+
+    /**
+     * The right side of the join.
+     *
+     * @var Traversable<Tr>
+     */
+    protected Traversable<Tr> $right;
+
+    /**
+     * Callback that returns the join key for a right value.
+     *
+     * @var (function(Tr): arraykey)
+     */
+    protected (function(Tr): arraykey) $rightKey;
+
+    /**
+     * Set both sides of the join, their key callbacks, whether to produce unmatched left values,
+     * and whether pairs must be produced in the order of the left side. Outer joins are always ordered.
+     *
+     * @param Traversable<Tl> $left
+     * @param (function(Tl): arraykey) $leftKey
+     * @param Traversable<Tr> $right
+     * @param (function(Tr): arraykey) $rightKey
+     * @param bool $outer
+     * @param bool $ordered
+     */
+    final public function __construct(
+        Traversable<Tl> $left,
+        (function(Tl): arraykey) $leftKey,
+        Traversable<Tr> $right,
+        (function(Tr): arraykey) $rightKey,
+        bool $outer = false,
+        bool $ordered = true
+    ) {
+        $this->left = $left;
+        $this->leftKey = $leftKey;
+        $this->right = $right;
+        $this->rightKey = $rightKey;
+        $this->outer = $outer;
+        $this->ordered = ($ordered || $outer);
+    }
+
+    /**
+     * Return a generator that builds the hash table and streams the other side through it.
+     *
+     * @return Iterator<Pair<Tl, ?Tr>>
+     */
+    public function getIterator(): Iterator<Pair<Tl, ?Tr>> {
+        $leftKey = $this->leftKey;
+        $rightKey = $this->rightKey;
+
+        // Only unordered inner joins may hash the left side, when it is known to be smaller
+        if (!$this->ordered && static::size($this->left) < static::size($this->right)) {
+            $table = static::table($this->left, $leftKey);
+
+            foreach ($this->right as $right) {
+                $key = $rightKey($right);
+
+                if ($table->contains($key)) {
+                    foreach ($table[$key] as $left) {
+                        yield Pair {$left, $right};
+                    }
+                }
+            }
+
+            return;
+        }
+
+        $table = static::table($this->right, $rightKey);
+
+        foreach ($this->left as $left) {
+            $key = $leftKey($left);
+
+            if ($table->contains($key)) {
+                foreach ($table[$key] as $right) {
+                    yield Pair {$left, $right};
+                }
+
+            } else if ($this->outer) {
+                yield Pair {$left, null};
+            }
+        }
+    }
+
+    /**
+     * Return the set of keys the callback returns for all values, in a single pass.
+     *
+     * @param Traversable<Tv> $values
+     * @param (function(Tv): arraykey) $callback
+     * @return Set<arraykey>
+     */
+    public static function keys<Tv>(Traversable<Tv> $values, (function(Tv): arraykey) $callback): Set<arraykey> {
+        $keys = Set {};
+
+        foreach ($values as $value) {
+            $keys[] = $callback($value);
+        }
+
+        return $keys;
+    }
+
+    /**
+     * Return the amount of values in a side, or the max integer if it can not be counted without iterating.
+     *
+     * @param Traversable<Tv> $values
+     * @return int
+     */
+    public static function size<Tv>(Traversable<Tv> $values): int {
+        if ($values instanceof Countable) {
+            return $values->count();
+        }
+
+        return PHP_INT_MAX;
+    }
+
+    /**
+     * Return a hash table of values grouped by the key the callback returns, in the order they were defined.
+     *
+     * @param Traversable<Tv> $values
+     * @param (function(Tv): arraykey) $callback
+     * @return Map<arraykey, Vector<Tv>>
+     */
+    public static function table<Tv>(Traversable<Tv> $values, (function(Tv): arraykey) $callback): Map<arraykey, Vector<Tv>> {
+        $table = Map {};
+
+        foreach ($values as $value) {
+            $key = $callback($value);
+
+            if ($table->contains($key)) {
+                $table[$key][] = $value;
+            } else {
+                $table[$key] = Vector {$value};
+            }
+        }
+
+        return $table;
+    }
+
+}
@@ -0,0 +1,214 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Json;
+
+use Titon\Type\ArrayList;
+use Titon\Type\HashMap;
+use Titon\Type\Sink;
+use \JsonSerializable;
+
+/**
+ * The Writer encodes values as JSON directly to a sink. Nested ArrayLists, HashMaps and collections
+ * are walked in place instead of being converted to arrays first, so memory usage does not depend
+ * on the size of the output, and output is available as soon as it is written.
+ *
+ * The output matches `json_encode()`: lists with sequential keys starting at 0 are written as arrays,
+ * other keyed collections as objects, and scalars are encoded with the defined `json_encode()` options.
+ * The `JSON_PRETTY_PRINT` and `JSON_FORCE_OBJECT` options are supported.
+ *
+ * @package Titon\Type\Json
+ */
+class Writer {
+
+    /**
+     * The json_encode() options.
+     *
+     * @var int
+     */
+    protected int $options;
+
+    /**
+     * Whether to pretty print the output.
+     *
+     * @var bool
+     */
+    protected bool $pretty;
+
+    /**
+     * The sink to write output to.
+     *
+     * @var \Titon\Type\Sink
+     */
+    protected Sink $sink;
+
+    /**
+     * Set the sink and encoding options.
+     *
+     * @param \Titon\Type\Sink $sink
+     * @param int $options
+     */
+    public function __construct(Sink $sink, int $options = 0) {
+        $this->sink = $sink;
+        $this->options = $options;
+        $this->pretty = (bool) ($options & JSON_PRETTY_PRINT);
+    }
+
+    /**
+     * Return the sink.
+     *
+     * @return \Titon\Type\Sink
+     */
+    public function getSink(): Sink {
+        return $this->sink;
+    }
+
+    /**
+     * Encode a value to the sink and flush it.
+     *
+     * @param mixed $value
+     * @return $this
+     */
+    public function write(mixed $value): this {
+        $this->writeValue($value, 0);
+
+        $this->sink->flush();
+
+        return $this;
+    }
+
+    /**
+     * Return true if the keys are sequential integers starting at 0, which json_encode() writes as an array.
+     *
+     * @param KeyedTraversable<mixed, mixed> $pairs
+     * @return bool
+     */
+    protected function isList(KeyedTraversable<mixed, mixed> $pairs): bool {
+        if ($this->options & JSON_FORCE_OBJECT) {
+            return false;
+        }
+
+        $index = 0;
+
+        foreach ($pairs as $key => $value) {
+            if ($key !== $index++) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Return an object key encoded as a JSON string, followed by the separator.
+     * Keys are always quoted, even when numeric strings are written as numbers.
+     *
+     * @param mixed $key
+     * @return string
+     */
+    protected function key(mixed $key): string {
+        return json_encode((string) $key, $this->options & ~JSON_NUMERIC_CHECK) . ($this->pretty ? ': ' : ':');
+    }
+
+    /**
+     * Return the newline and indentation that precedes a member when pretty printing.
+     *
+     * @param int $depth
+     * @return string
+     */
+    protected function newline(int $depth): string {
+        return $this->pretty ? PHP_EOL . str_repeat('    ', $depth) : '';
+    }
+
+    /**
+     * Write the values of a list as a JSON array, or as an object keyed by position when forcing objects.
+     *
+     * @param Traversable<mixed> $values
+     * @param int $depth
+     */
+    protected function writeList(Traversable<mixed> $values, int $depth): void {
+        $object = (bool) ($this->options & JSON_FORCE_OBJECT);
+        $sink = $this->sink;
+        $first = true;
+        $index = 0;
+
+        $sink->write($object ? '{' : '[');
+
+        foreach ($values as $value) {
+            $sink->write(($first ? '' : ',') . $this->newline($depth + 1) . ($object ? $this->key($index++) : ''));
+            $first = false;
+
+            $this->writeValue($value, $depth + 1);
+        }
+
+        $sink->write(($first ? '' : $this->newline($depth)) . ($object ? '}' : ']'));
+    }
+
+    /**
+     * Write the pairs as a JSON object.
+     *
+     * @param KeyedTraversable<mixed, mixed> $pairs
+     * @param int $depth
+     */
+    protected function writeObject(KeyedTraversable<mixed, mixed> $pairs, int $depth): void {
+        $sink = $this->sink;
+        $first = true;
+
+        $sink->write('{');
+
+        foreach ($pairs as $key => $value) {
+            $sink->write(($first ? '' : ',') . $this->newline($depth + 1) . $this->key($key));
+            $first = false;
+
+            $this->writeValue($value, $depth + 1);
+        }
+
+        $sink->write(($first ? '' : $this->newline($depth)) . '}');
+    }
+
+    /**
+     * Write keyed pairs as either an array or an object, depending on the keys.
+     *
+     * @param KeyedTraversable<mixed, mixed> $pairs
+     * @param int $depth
+     */
+    protected function writePairs(KeyedTraversable<mixed, mixed> $pairs, int $depth): void {
+        if ($this->isList($pairs)) {
+            $this->writeList($pairs, $depth);
+        } else {
+            $this->writeObject($pairs, $depth);
+        }
+    }
+
+    /**
+     * Write a value of any type.
+     *
+     * @param mixed $value
+     * @param int $depth
+     */
+    protected function writeValue(mixed $value, int $depth): void {
+        if ($value instanceof ArrayList) {
+            $this->writeList($value->view(), $depth);
+
+        } else if ($value instanceof HashMap) {
+            $this->writePairs($value->view(), $depth);
+
+        } else if ($value instanceof Vector || $value instanceof ImmVector || $value instanceof Set || $value instanceof ImmSet) {
+            $this->writeList($value, $depth);
+
+        } else if ($value instanceof Map || $value instanceof ImmMap || is_array($value)) {
+            $this->writePairs($value, $depth);
+
+        } else if ($value instanceof JsonSerializable) {
+            $this->writeValue($value->jsonSerialize(), $depth);
+
+        } else {
+            $this->sink->write(json_encode($value, $this->options));
+        }
+    }
+
+}
@@ -0,0 +1,306 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+use Titon\Common\Arrayable;
+use Titon\Common\Vectorable;
+use \Countable;
+use \IteratorAggregate;
+
+/**
+ * The LazyList is a deferred view over a list of values. Chained filter, map, skip, take, and unique calls
+ * are recorded as stages instead of being executed, and are fused into a single pass over the source
+ * once a terminal method (iteration, count, first, toVector, etc) is called.
+ *
+ * Since the source is not copied, changes to the source are reflected in the view. When the view is created
+ * from a list, the list's ref count is acquired instead, so that the list copies its values before modifying them.
+ *
+ * @package Titon\Type
+ */
+class LazyList<Tv> implements
+    IteratorAggregate<Tv>,
+    Countable,
+    Arrayable<int, Tv>,
+    Vectorable<Tv> {
+
+    const int FILTER = 1;
+    const int MAP = 2;
+    const int SKIP = 3;
+    const int TAKE = 4;
+    const int UNIQUE = 5;
+
+    /**
+     * Ref count of the source, so that the owner copies the source before modifying it.
+     *
+     * @var \Titon\Type\RefCount
+     */
+    protected ?RefCount $refs;
+
+    /**
+     * The traversable that stages are applied to.
+     *
+     * @var Traversable<mixed>
+     */
+    protected Traversable<mixed> $source;
+
+    /**
+     * List of recorded stages, in the order they should be applied.
+     * Each stage is a pair of the stage type and its argument (a callback or a limit).
+     *
+     * @var Vector<Pair<int, mixed>>
+     */
+    protected Vector<Pair<int, mixed>> $stages;
+
+    /**
+     * Set the source and any previously recorded stages.
+     * If a ref count is defined, it is acquired for the lifetime of the view.
+     *
+     * @param Traversable<mixed> $source
+     * @param Vector<Pair<int, mixed>> $stages
+     * @param \Titon\Type\RefCount $refs
+     */
+    final public function __construct(Traversable<mixed> $source, Vector<Pair<int, mixed>> $stages = Vector {}, ?RefCount $refs = null) {
+        $this->source = $source;
+        $this->stages = $stages;
+        $this->refs = $refs;
+
+        if ($refs !== null) {
+            $refs->acquire();
+        }
+    }
+
+    /**
+     * Release the source once the view is no longer used.
+     */
+    public function __destruct(): void {
+        if ($this->refs !== null) {
+            $this->refs->release();
+        }
+    }
+
+    /**
+     * Run all stages and return the number of values that were produced.
+     *
+     * @return int
+     */
+    public function count(): int {
+        $count = 0;
+
+        foreach ($this->getIterator() as $value) {
+            ++$count;
+        }
+
+        return $count;
+    }
+
+    /**
+     * Record a stage that removes all values that do not satisfy the callback.
+     *
+     * @param (function(Tv): bool) $callback
+     * @return \Titon\Type\LazyList<Tv>
+     */
+    public function filter((function(Tv): bool) $callback): LazyList<Tv> {
+        return $this->pipe(static::FILTER, $callback);
+    }
+
+    /**
+     * Run the stages until the first value is produced and return it.
+     * If no value is produced, null is returned.
+     *
+     * @return ?Tv
+     */
+    public function first(): ?Tv {
+        foreach ($this->getIterator() as $value) {
+            return $value;
+        }
+
+        return null;
+    }
+
+    /**
+     * Return a generator that applies every stage to each value of the source in a single pass.
+     *
+     * @return Iterator<Tv>
+     */
+    public function getIterator(): Iterator<Tv> {
+        // UNSAFE
+        // Stages are stored untyped so that map stages can change the type of values between stages
+        $stages = $this->stages;
+        $counts = Vector {};
+        $seen = Vector {};
+        $done = false;
+
+        foreach ($stages as $stage) {
+            $counts[] = 0;
+            $seen[] = ($stage[0] === static::UNIQUE) ? Pair {Map {}, Vector {}} : null;
+        }
+
+        foreach ($this->source as $value) {
+
+            // A take limit was reached on the previous value
+            if ($done) {
+                return;
+            }
+
+            foreach ($stages as $i => $stage) {
+                $type = $stage[0];
+                $arg = $stage[1];
+
+                if ($type === static::FILTER) {
+                    if (!$arg($value)) {
+                        continue 2;
+                    }
+
+                } else if ($type === static::MAP) {
+                    $value = $arg($value);
+
+                } else if ($type === static::SKIP) {
+                    if ($counts[$i] < $arg) {
+                        $counts[$i]++;
+                        continue 2;
+                    }
+
+                } else if ($type === static::TAKE) {
+                    if ($counts[$i] >= $arg) {
+                        return;
+                    }
+
+                    $counts[$i]++;
+
+                    if ($counts[$i] >= $arg) {
+                        $done = true;
+                    }
+
+                } else if ($type === static::UNIQUE) {
+                    list($keys, $others) = $seen[$i];
+
+                    // Hashable values can be checked in constant time
+                    if (is_int($value) || is_string($value)) {
+                        if ($keys->contains($value)) {
+                            continue 2;
+                        }
+
+                        $keys[$value] = true;
+
+                    } else {
+                        if (in_array($value, $others, true)) {
+                            continue 2;
+                        }
+
+                        $others[] = $value;
+                    }
+                }
+            }
+
+            yield $value;
+        }
+    }
+
+    /**
+     * Return true if no values are produced by the stages.
+     *
+     * @return bool
+     */
+    public function isEmpty(): bool {
+        foreach ($this->getIterator() as $value) {
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Record a stage that transforms each value with the callback.
+     *
+     * @param (function(Tv): Tu) $callback
+     * @return \Titon\Type\LazyList<Tu>
+     */
+    public function map<Tu>((function(Tv): Tu) $callback): LazyList<Tu> {
+        // UNSAFE
+        // The recorded stages are untyped so the new value type can not be inferred
+        return $this->pipe(static::MAP, $callback);
+    }
+
+    /**
+     * Record a stage that skips the first values that reach it.
+     *
+     * @param int $count
+     * @return \Titon\Type\LazyList<Tv>
+     */
+    public function skip(int $count): LazyList<Tv> {
+        return $this->pipe(static::SKIP, $count);
+    }
+
+    /**
+     * Record a stage that stops the pass once the defined amount of values have reached it.
+     *
+     * @param int $count
+     * @return \Titon\Type\LazyList<Tv>
+     */
+    public function take(int $count): LazyList<Tv> {
+        return $this->pipe(static::TAKE, $count);
+    }
+
+    /**
+     * Run all stages and return the values as an array.
+     *
+     * @return array<int, Tv>
+     */
+    public function toArray(): array<int, Tv> {
+        $array = [];
+
+        foreach ($this->getIterator() as $value) {
+            $array[] = $value;
+        }
+
+        return $array;
+    }
+
+    /**
+     * Run all stages and return the values as an ArrayList.
+     *
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    public function toArrayList(): ArrayList<Tv> {
+        return new ArrayList($this->toVector());
+    }
+
+    /**
+     * Run all stages and return the values as a vector.
+     *
+     * @return Vector<Tv>
+     */
+    public function toVector(): Vector<Tv> {
+        return new Vector($this->getIterator());
+    }
+
+    /**
+     * Record a stage that removes duplicate values, keeping the first occurrence.
+     * Integers and strings are checked by hash, while other values are checked by strict comparison.
+     *
+     * @return \Titon\Type\LazyList<Tv>
+     */
+    public function unique(): LazyList<Tv> {
+        return $this->pipe(static::UNIQUE, null);
+    }
+
+    /**
+     * Return a new LazyList with the stage appended to the currently recorded stages.
+     *
+     * @param int $type
+     * @param mixed $arg
+     * @return \Titon\Type\LazyList<Tv>
+     */
+    protected function pipe(int $type, mixed $arg): LazyList<Tv> {
+        $stages = $this->stages->toVector();
+        $stages[] = Pair {$type, $arg};
+
+        return new static($this->source, $stages, $this->refs);
+    }
+
+}
@@ -0,0 +1,225 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+use Titon\Common\Arrayable;
+use Titon\Common\Vectorable;
+use \Countable;
+use \IteratorAggregate;
+use \JsonSerializable;
+
+/**
+ * The ListSlice is a lightweight read-only view over a range of a vector. Values are not copied
+ * until the slice is converted, so slicing a list costs the same no matter how large the range is.
+ *
+ * @package Titon\Type
+ */
+class ListSlice<Tv> implements
+    IteratorAggregate<Tv>,
+    Countable,
+    JsonSerializable,
+    Arrayable<int, Tv>,
+    Vectorable<Tv> {
+
+    /**
+     * Amount of values in the slice.
+     *
+     * @var int
+     */
+    protected int $length;
+
+    /**
+     * Index in the source where the slice begins.
+     *
+     * @var int
+     */
+    protected int $offset;
+
+    /**
+     * Ref count of the source, so that the owner copies the source before modifying it.
+     *
+     * @var \Titon\Type\RefCount
+     */
+    protected ?RefCount $refs;
+
+    /**
+     * The vector being viewed.
+     *
+     * @var Vector<Tv>
+     */
+    protected Vector<Tv> $source;
+
+    /**
+     * Set the source and the range to view. The range is clamped to the bounds of the source.
+     * If a ref count is defined, it is acquired for the lifetime of the slice.
+     *
+     * @param Vector<Tv> $source
+     * @param int $offset
+     * @param int $length
+     * @param \Titon\Type\RefCount $refs
+     */
+    public function __construct(Vector<Tv> $source, int $offset, int $length, ?RefCount $refs = null) {
+        $count = $source->count();
+        $offset = min(max($offset, 0), $count);
+
+        $this->source = $source;
+        $this->offset = $offset;
+        $this->length = min(max($length, 0), $count - $offset);
+        $this->refs = $refs;
+
+        if ($refs !== null) {
+            $refs->acquire();
+        }
+    }
+
+    /**
+     * Release the source once the slice is no longer used.
+     */
+    public function __destruct(): void {
+        if ($this->refs !== null) {
+            $this->refs->release();
+        }
+    }
+
+    /**
+     * Return the value at the index within the slice, or throw an exception if out of bounds.
+     *
+     * @param int $index
+     * @return Tv
+     * @throws \OutOfBoundsException
+     */
+    public function at(int $index): Tv {
+        if ($index < 0 || $index >= $this->length) {
+            throw new \OutOfBoundsException(sprintf('Integer key %s is out of bounds', $index));
+        }
+
+        return $this->source[$this->offset + $index];
+    }
+
+    /**
+     * Return the size of the slice.
+     *
+     * @return int
+     */
+    public function count(): int {
+        return $this->length;
+    }
+
+    /**
+     * Return the first value in the slice.
+     *
+     * @return ?Tv
+     */
+    public function first(): ?Tv {
+        return $this->get(0);
+    }
+
+    /**
+     * Return the value at the index within the slice, or null if out of bounds.
+     *
+     * @param int $index
+     * @return ?Tv
+     */
+    public function get(int $index): ?Tv {
+        if ($index < 0 || $index >= $this->length) {
+            return null;
+        }
+
+        return $this->source[$this->offset + $index];
+    }
+
+    /**
+     * Return a generator that loops over the range.
+     *
+     * @return Iterator<Tv>
+     */
+    public function getIterator(): Iterator<Tv> {
+        $source = $this->source;
+
+        for ($i = $this->offset, $end = $this->offset + $this->length; $i < $end; $i++) {
+            yield $source[$i];
+        }
+    }
+
+    /**
+     * Return the index in the source where the slice begins.
+     *
+     * @return int
+     */
+    public function getOffset(): int {
+        return $this->offset;
+    }
+
+    /**
+     * Return true if the slice is empty.
+     *
+     * @return bool
+     */
+    public function isEmpty(): bool {
+        return ($this->length === 0);
+    }
+
+    /**
+     * Return an array for JSON encoding.
+     *
+     * @return array<int, Tv>
+     */
+    public function jsonSerialize(): array<int, Tv> {
+        return $this->toArray();
+    }
+
+    /**
+     * Return the last value in the slice.
+     *
+     * @return ?Tv
+     */
+    public function last(): ?Tv {
+        return $this->get($this->length - 1);
+    }
+
+    /**
+     * Copy the range into an array.
+     *
+     * @return array<int, Tv>
+     */
+    public function toArray(): array<int, Tv> {
+        $array = [];
+
+        foreach ($this->getIterator() as $value) {
+            $array[] = $value;
+        }
+
+        return $array;
+    }
+
+    /**
+     * Copy the range into an ArrayList.
+     *
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    public function toArrayList(): ArrayList<Tv> {
+        return new ArrayList($this->toVector());
+    }
+
+    /**
+     * Copy the range into a vector.
+     *
+     * @return Vector<Tv>
+     */
+    public function toVector(): Vector<Tv> {
+        $vector = Vector {};
+        $vector->reserve($this->length);
+
+        foreach ($this->getIterator() as $value) {
+            $vector[] = $value;
+        }
+
+        return $vector;
+    }
+
+}
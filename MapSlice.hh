@@ -0,0 +1,256 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+use Titon\Common\Arrayable;
+use Titon\Common\Mapable;
+use Titon\Common\Vectorable;
+use \Countable;
+use \IteratorAggregate;
+use \JsonSerializable;
+
+/**
+ * The MapSlice is a lightweight read-only view over a positional range of a map. Entries are not copied
+ * until the slice is converted, so slicing a map costs the same no matter how large the range is.
+ *
+ * @package Titon\Type
+ */
+class MapSlice<Tk, Tv> implements
+    IteratorAggregate<Tv>,
+    Countable,
+    JsonSerializable,
+    Arrayable<Tk, Tv>,
+    Mapable<Tk, Tv>,
+    Vectorable<Tv> {
+
+    /**
+     * Keys of the source in insertion order.
+     *
+     * @var Vector<Tk>
+     */
+    protected Vector<Tk> $keys;
+
+    /**
+     * Amount of entries in the slice.
+     *
+     * @var int
+     */
+    protected int $length;
+
+    /**
+     * Position in the source where the slice begins.
+     *
+     * @var int
+     */
+    protected int $offset;
+
+    /**
+     * Ref count of the source, so that the owner copies the source before modifying it.
+     *
+     * @var \Titon\Type\RefCount
+     */
+    protected ?RefCount $refs;
+
+    /**
+     * The map being viewed.
+     *
+     * @var Map<Tk, Tv>
+     */
+    protected Map<Tk, Tv> $source;
+
+    /**
+     * Set the source, its ordered keys, and the range to view. The range is clamped to the bounds of the source.
+     * If a ref count is defined, it is acquired for the lifetime of the slice.
+     *
+     * @param Map<Tk, Tv> $source
+     * @param Vector<Tk> $keys
+     * @param int $offset
+     * @param int $length
+     * @param \Titon\Type\RefCount $refs
+     */
+    public function __construct(Map<Tk, Tv> $source, Vector<Tk> $keys, int $offset, int $length, ?RefCount $refs = null) {
+        $count = $keys->count();
+        $offset = min(max($offset, 0), $count);
+
+        $this->source = $source;
+        $this->keys = $keys;
+        $this->offset = $offset;
+        $this->length = min(max($length, 0), $count - $offset);
+        $this->refs = $refs;
+
+        if ($refs !== null) {
+            $refs->acquire();
+        }
+    }
+
+    /**
+     * Release the source once the slice is no longer used.
+     */
+    public function __destruct(): void {
+        if ($this->refs !== null) {
+            $this->refs->release();
+        }
+    }
+
+    /**
+     * Return the size of the slice.
+     *
+     * @return int
+     */
+    public function count(): int {
+        return $this->length;
+    }
+
+    /**
+     * Return the first value in the slice.
+     *
+     * @return ?Tv
+     */
+    public function first(): ?Tv {
+        return $this->valueAt(0);
+    }
+
+    /**
+     * Return a generator that loops over the range, yielding keys and values.
+     *
+     * @return KeyedIterator<Tk, Tv>
+     */
+    public function getIterator(): KeyedIterator<Tk, Tv> {
+        $source = $this->source;
+        $keys = $this->keys;
+
+        for ($i = $this->offset, $end = $this->offset + $this->length; $i < $end; $i++) {
+            $key = $keys[$i];
+
+            yield $key => $source[$key];
+        }
+    }
+
+    /**
+     * Return the position in the source where the slice begins.
+     *
+     * @return int
+     */
+    public function getOffset(): int {
+        return $this->offset;
+    }
+
+    /**
+     * Return true if the slice is empty.
+     *
+     * @return bool
+     */
+    public function isEmpty(): bool {
+        return ($this->length === 0);
+    }
+
+    /**
+     * Return an array for JSON encoding.
+     *
+     * @return array<Tk, Tv>
+     */
+    public function jsonSerialize(): array<Tk, Tv> {
+        return $this->toArray();
+    }
+
+    /**
+     * Return the key at the position within the slice, or null if out of bounds.
+     *
+     * @param int $position
+     * @return ?Tk
+     */
+    public function keyAt(int $position): ?Tk {
+        if ($position < 0 || $position >= $this->length) {
+            return null;
+        }
+
+        return $this->keys[$this->offset + $position];
+    }
+
+    /**
+     * Return the last value in the slice.
+     *
+     * @return ?Tv
+     */
+    public function last(): ?Tv {
+        return $this->valueAt($this->length - 1);
+    }
+
+    /**
+     * Copy the range into an array.
+     *
+     * @return array<Tk, Tv>
+     */
+    public function toArray(): array<Tk, Tv> {
+        $array = [];
+
+        foreach ($this->getIterator() as $key => $value) {
+            $array[$key] = $value;
+        }
+
+        return $array;
+    }
+
+    /**
+     * Copy the range into a HashMap.
+     *
+     * @return \Titon\Type\HashMap<Tk, Tv>
+     */
+    public function toHashMap(): HashMap<Tk, Tv> {
+        return new HashMap($this->toMap());
+    }
+
+    /**
+     * Copy the range into a map.
+     *
+     * @return Map<Tk, Tv>
+     */
+    public function toMap(): Map<Tk, Tv> {
+        $map = Map {};
+        $map->reserve($this->length);
+
+        foreach ($this->getIterator() as $key => $value) {
+            $map[$key] = $value;
+        }
+
+        return $map;
+    }
+
+    /**
+     * Copy the values of the range into a vector.
+     *
+     * @return Vector<Tv>
+     */
+    public function toVector(): Vector<Tv> {
+        $vector = Vector {};
+        $vector->reserve($this->length);
+
+        foreach ($this->getIterator() as $value) {
+            $vector[] = $value;
+        }
+
+        return $vector;
+    }
+
+    /**
+     * Return the value at the position within the slice, or null if out of bounds.
+     *
+     * @param int $position
+     * @return ?Tv
+     */
+    public function valueAt(int $position): ?Tv {
+        $key = $this->keyAt($position);
+
+        if ($key === null) {
+            return null;
+        }
+
+        return $this->source[$key];
+    }
+
+}
@@ -0,0 +1,30 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+/**
+ * The NumericList is an extension of the ArrayList for lists that only contain numbers.
+ * Sorting is numeric by default, while the aggregate methods (average, max, min, sum) are inherited from the ArrayList.
+ * The IntList and FloatList narrow `sum()` to their value type.
+ *
+ * @package Titon\Type
+ */
+abstract class NumericList<Tv as num> extends ArrayList<Tv> {
+
+    /**
+     * Sort the numbers in the list using a custom callback or numerically.
+     *
+     * @param (function(Tv, Tv): int) $callback
+     * @param int $flags
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    public function sort(?(function(Tv, Tv): int) $callback = null, int $flags = SORT_NUMERIC): ArrayList<Tv> {
+        return parent::sort($callback, $flags);
+    }
+
+}
@@ -7,11 +7,269 @@
 
 namespace Titon\Type;
 
+use Titon\Type\Exception\MissingIndexException;
+
 /**
  * The ObjectCollection is an extension of the HashMap that provides functionality for managing lists of objects of the same type.
  *
+ * Objects can be looked up by a property other than their key through secondary indexes, which are declared
+ * with `addIndex()`. Each index groups the objects by the value that its callback returns, is built lazily
+ * on first lookup, and is kept up to date in place when objects are set or removed.
+ *
  * @package Titon\Type
  */
 class ObjectCollection<Tk, Tv> extends HashMap<Tk, Tv> {
 
-}
\ No newline at end of file
+    /**
+     * Callbacks that return the indexed value for an object, mapped by index name.
+     *
+     * @var Map<string, (function(Tv): arraykey)>
+     */
+    protected Map<string, (function(Tv): arraykey)> $indexers = Map {};
+
+    /**
+     * Built indexes, mapping each indexed value to the objects that have it, mapped by index name.
+     *
+     * @var Map<string, Map<arraykey, Map<Tk, Tv>>>
+     */
+    protected Map<string, Map<arraykey, Map<Tk, Tv>>> $indexes = Map {};
+
+    /**
+     * The value each key was indexed under, mapped by index name. Allows objects that have changed
+     * since they were indexed to be removed from the correct group.
+     *
+     * @var Map<string, Map<Tk, arraykey>>
+     */
+    protected Map<string, Map<Tk, arraykey>> $indexed = Map {};
+
+    /**
+     * Declare a secondary index. The callback receives each object and returns the value to index it by.
+     * Redeclaring an index replaces it.
+     *
+     * @param string $name
+     * @param (function(Tv): arraykey) $callback
+     * @return $this
+     */
+    public function addIndex(string $name, (function(Tv): arraykey) $callback): this {
+        // Indexers are shared with clones, so copy them before modifying
+        $indexers = $this->indexers->toMap();
+        $indexers[$name] = $callback;
+
+        $this->indexers = $indexers;
+        $this->dropIndex($name);
+
+        return $this;
+    }
+
+    /**
+     * Return all objects whose indexed value matches, in O(k) for k matches.
+     *
+     * @param string $name
+     * @param arraykey $value
+     * @return \Titon\Type\HashMap<Tk, Tv>
+     * @throws \Titon\Type\Exception\MissingIndexException
+     */
+    public function findAllBy(string $name, arraykey $value): HashMap<Tk, Tv> {
+        $group = $this->index($name)->get($value);
+
+        return $this->wrap(($group === null) ? Map {} : $group->toMap());
+    }
+
+    /**
+     * Return the first object whose indexed value matches, or null if none match, in O(1).
+     *
+     * @param string $name
+     * @param arraykey $value
+     * @return ?Tv
+     * @throws \Titon\Type\Exception\MissingIndexException
+     */
+    public function findBy(string $name, arraykey $value): ?Tv {
+        $group = $this->index($name)->get($value);
+
+        return ($group === null) ? null : $group->firstValue();
+    }
+
+    /**
+     * Group all objects into sub-maps by their indexed value. Equivalent to `groupBy()` with the index callback,
+     * but reuses the index instead of calling the callback for every object.
+     *
+     * @param string $name
+     * @return \Titon\Type\HashMap<arraykey, HashMap<Tk, Tv>>
+     * @throws \Titon\Type\Exception\MissingIndexException
+     */
+    public function groupByIndex(string $name): HashMap<arraykey, HashMap<Tk, Tv>> {
+        $groups = Map {};
+
+        foreach ($this->index($name) as $value => $group) {
+            $groups[$value] = $this->wrap($group->toMap());
+        }
+
+        return (new HashMap())->adopt($groups);
+    }
+
+    /**
+     * Return true if the index has been declared.
+     *
+     * @param string $name
+     * @return bool
+     */
+    public function hasIndex(string $name): bool {
+        return $this->indexers->contains($name);
+    }
+
+    /**
+     * Remove a value from the map and its indexes.
+     *
+     * @param Tk $key
+     * @return $this
+     */
+    public function remove(Tk $key): this {
+        $this->unindexObject($key);
+
+        // Avoid the parent invalidating the secondary indexes
+        $this->detach()->removeKey($key);
+        parent::invalidate();
+
+        return $this;
+    }
+
+    /**
+     * Remove a declared index.
+     *
+     * @param string $name
+     * @return $this
+     */
+    public function removeIndex(string $name): this {
+        $indexers = $this->indexers->toMap();
+        $indexers->remove($name);
+
+        $this->indexers = $indexers;
+        $this->dropIndex($name);
+
+        return $this;
+    }
+
+    /**
+     * Set the value for the specified key and update its indexes.
+     * Objects that are modified in place should be set again so that their indexes are updated.
+     *
+     * @param Tk $key
+     * @param Tv $value
+     * @return $this
+     */
+    public function set(Tk $key, Tv $value): this {
+        $this->unindexObject($key);
+
+        parent::set($key, $value);
+
+        $this->indexObject($key, $value);
+
+        return $this;
+    }
+
+    /**
+     * Discard a built index so that it is rebuilt on the next lookup.
+     *
+     * @param string $name
+     */
+    protected function dropIndex(string $name): void {
+        $this->indexes->remove($name);
+        $this->indexed->remove($name);
+    }
+
+    /**
+     * Return the index, building it if it does not exist.
+     *
+     * @param string $name
+     * @return Map<arraykey, Map<Tk, Tv>>
+     * @throws \Titon\Type\Exception\MissingIndexException
+     */
+    protected function index(string $name): Map<arraykey, Map<Tk, Tv>> {
+        $index = $this->indexes->get($name);
+
+        if ($index !== null) {
+            return $index;
+        }
+
+        $callback = $this->indexers->get($name);
+
+        if ($callback === null) {
+            throw new MissingIndexException(sprintf('Index "%s" has not been defined for %s', $name, static::class));
+        }
+
+        $index = Map {};
+        $indexed = Map {};
+
+        foreach ($this->value as $key => $object) {
+            $value = $callback($object);
+            $indexed[$key] = $value;
+
+            if ($index->contains($value)) {
+                $index[$value][$key] = $object;
+            } else {
+                $index[$value] = Map {$key => $object};
+            }
+        }
+
+        $this->indexes[$name] = $index;
+        $this->indexed[$name] = $indexed;
+
+        return $index;
+    }
+
+    /**
+     * Add an object to every built index.
+     *
+     * @param Tk $key
+     * @param Tv $object
+     */
+    protected function indexObject(Tk $key, Tv $object): void {
+        foreach ($this->indexes as $name => $index) {
+            $callback = $this->indexers[$name];
+            $value = $callback($object);
+
+            $this->indexed[$name][$key] = $value;
+
+            if ($index->contains($value)) {
+                $index[$value][$key] = $object;
+            } else {
+                $index[$value] = Map {$key => $object};
+            }
+        }
+    }
+
+    /**
+     * Reset all lazily built indexes, including the secondary indexes. Should be called after the map has been modified.
+     */
+    protected function invalidate(): void {
+        parent::invalidate();
+
+        $this->indexes = Map {};
+        $this->indexed = Map {};
+    }
+
+    /**
+     * Remove the object at the key from every built index, using the value it was indexed under.
+     *
+     * @param Tk $key
+     */
+    protected function unindexObject(Tk $key): void {
+        foreach ($this->indexes as $name => $index) {
+            $indexed = $this->indexed[$name];
+
+            if (!$indexed->contains($key)) {
+                continue;
+            }
+
+            $value = $indexed[$key];
+            $group = $index[$value];
+            $group->remove($key);
+            $indexed->remove($key);
+
+            if ($group->isEmpty()) {
+                $index->remove($value);
+            }
+        }
+    }
+
+}
@@ -0,0 +1,537 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+use Titon\Common\Arrayable;
+use Titon\Common\Vectorable;
+use \Countable;
+use \IteratorAggregate;
+use \OutOfBoundsException;
+
+/**
+ * The PersistentList is an immutable list with structural sharing. Values are stored in a 32-way trie
+ * with a separate tail for the last 32 values. Every modification returns a new list that shares all
+ * untouched nodes with the original, so appending, setting, and removing the last value only copy
+ * the nodes along a single path, which is O(log32 n) instead of a full copy.
+ *
+ * Prepending and removing from the middle require values to shift position, which is O(n), just like a Vector.
+ *
+ * @package Titon\Type
+ */
+class PersistentList<Tv> implements
+    IteratorAggregate<Tv>,
+    Countable,
+    Arrayable<int, Tv>,
+    Vectorable<Tv> {
+
+    const int BITS = 5;
+    const int WIDTH = 32;
+    const int MASK = 31;
+
+    /**
+     * Number of values in the list.
+     *
+     * @var int
+     */
+    protected int $count = 0;
+
+    /**
+     * Root node of the trie. Branch nodes contain child nodes, while leaf nodes contain values.
+     *
+     * @var Vector<mixed>
+     */
+    protected Vector<mixed> $root = Vector {};
+
+    /**
+     * Amount of bits to shift an index by to get the position within the root node.
+     *
+     * @var int
+     */
+    protected int $shift = 5;
+
+    /**
+     * The last (up to 32) values, which are not in the trie yet.
+     *
+     * @var Vector<Tv>
+     */
+    protected Vector<Tv> $tail = Vector {};
+
+    /**
+     * Build the list from a list of values. The trie is built bottom up in a single pass.
+     *
+     * @param Traversable<Tv> $values
+     */
+    final public function __construct(Traversable<Tv> $values = Vector {}) {
+        $values = new Vector($values);
+        $count = $values->count();
+
+        if ($count === 0) {
+            return;
+        }
+
+        $offset = static::tailOffset($count);
+        $nodes = Vector {};
+
+        // Leaf nodes for every full block of values before the tail
+        for ($i = 0; $i < $offset; $i += static::WIDTH) {
+            $nodes[] = $values->slice($i, static::WIDTH)->toVector();
+        }
+
+        // Group nodes into parents until they fit within the root
+        $shift = static::BITS;
+
+        while ($nodes->count() > static::WIDTH) {
+            $parents = Vector {};
+
+            for ($i = 0, $length = $nodes->count(); $i < $length; $i += static::WIDTH) {
+                $parents[] = $nodes->slice($i, static::WIDTH)->toVector();
+            }
+
+            $nodes = $parents;
+            $shift += static::BITS;
+        }
+
+        $this->count = $count;
+        $this->shift = $shift;
+        $this->root = $nodes;
+        $this->tail = $values->slice($offset, $count - $offset)->toVector();
+    }
+
+    /**
+     * Return a new list with the value appended to the end.
+     *
+     * @param Tv $value
+     * @return \Titon\Type\PersistentList<Tv>
+     */
+    public function append(Tv $value): PersistentList<Tv> {
+        $count = $this->count;
+
+        // Room in the tail
+        if (($count - static::tailOffset($count)) < static::WIDTH) {
+            $tail = $this->tail->toVector();
+            $tail[] = $value;
+
+            return $this->derive($count + 1, $this->shift, $this->root, $tail);
+        }
+
+        // Push the full tail into the trie
+        $shift = $this->shift;
+
+        if (($count >> static::BITS) > (1 << $shift)) {
+            $root = Vector {$this->root, static::newPath($shift, $this->tail)};
+            $shift += static::BITS;
+        } else {
+            $root = $this->pushTail($shift, $this->root, $this->tail);
+        }
+
+        return $this->derive($count + 1, $shift, $root, Vector {$value});
+    }
+
+    /**
+     * Return the value at the specified index or throw an exception.
+     *
+     * @param int $index
+     * @return Tv
+     * @throws \OutOfBoundsException
+     */
+    public function at(int $index): Tv {
+        if ($index < 0 || $index >= $this->count) {
+            throw new OutOfBoundsException(sprintf('Index %s is out of bounds', $index));
+        }
+
+        return $this->leafFor($index)[$index & static::MASK];
+    }
+
+    /**
+     * Return a new list with the values appended to the end.
+     *
+     * @param Traversable<Tv> $values
+     * @return \Titon\Type\PersistentList<Tv>
+     */
+    public function concat(Traversable<Tv> $values): PersistentList<Tv> {
+        $list = $this;
+
+        foreach ($values as $value) {
+            $list = $list->append($value);
+        }
+
+        return $list;
+    }
+
+    /**
+     * Return the number of values.
+     *
+     * @return int
+     */
+    public function count(): int {
+        return $this->count;
+    }
+
+    /**
+     * Return the first value or null if the list is empty.
+     *
+     * @return ?Tv
+     */
+    public function first(): ?Tv {
+        return $this->get(0);
+    }
+
+    /**
+     * Return the value at the specified index or null if it does not exist.
+     *
+     * @param int $index
+     * @return ?Tv
+     */
+    public function get(int $index): ?Tv {
+        if ($index < 0 || $index >= $this->count) {
+            return null;
+        }
+
+        return $this->leafFor($index)[$index & static::MASK];
+    }
+
+    /**
+     * Return an iterator that walks the leaf nodes in order.
+     *
+     * @return Iterator<Tv>
+     */
+    public function getIterator(): Iterator<Tv> {
+        for ($i = 0, $count = $this->count; $i < $count; $i += static::WIDTH) {
+            foreach ($this->leafFor($i) as $value) {
+                yield $value;
+            }
+        }
+    }
+
+    /**
+     * Return true if the list is empty.
+     *
+     * @return bool
+     */
+    public function isEmpty(): bool {
+        return ($this->count === 0);
+    }
+
+    /**
+     * Return the last value or null if the list is empty.
+     *
+     * @return ?Tv
+     */
+    public function last(): ?Tv {
+        return $this->get($this->count - 1);
+    }
+
+    /**
+     * Return a new list without the last value.
+     *
+     * @return \Titon\Type\PersistentList<Tv>
+     * @throws \OutOfBoundsException
+     */
+    public function pop(): PersistentList<Tv> {
+        $count = $this->count;
+
+        if ($count === 0) {
+            throw new OutOfBoundsException('Can not pop an empty list');
+
+        } else if ($count === 1) {
+            return new static();
+        }
+
+        // More than one value in the tail
+        if (($count - static::tailOffset($count)) > 1) {
+            $tail = $this->tail->toVector();
+            $tail->pop();
+
+            return $this->derive($count - 1, $this->shift, $this->root, $tail);
+        }
+
+        // Pull the last leaf out of the trie and use it as the tail
+        // UNSAFE
+        // Leaf nodes are stored untyped within the trie
+        $tail = $this->leafFor($count - 2);
+        $root = $this->popTail($this->shift, $this->root) ?: Vector {};
+        $shift = $this->shift;
+
+        // Collapse the root if it only has a single child
+        if ($shift > static::BITS && $root->count() === 1) {
+            $root = $root[0];
+            $shift -= static::BITS;
+        }
+
+        return $this->derive($count - 1, $shift, $root, $tail);
+    }
+
+    /**
+     * Return a new list with the value prepended to the beginning. Since every value shifts position, this is O(n).
+     *
+     * @param Tv $value
+     * @return \Titon\Type\PersistentList<Tv>
+     */
+    public function prepend(Tv $value): PersistentList<Tv> {
+        $values = Vector {$value};
+        $values->addAll($this);
+
+        return new static($values);
+    }
+
+    /**
+     * Return a new list without the value at the specified index. Removing the last value is O(log32 n),
+     * while any other index requires following values to shift position, which is O(n).
+     *
+     * @param int $index
+     * @return \Titon\Type\PersistentList<Tv>
+     * @throws \OutOfBoundsException
+     */
+    public function remove(int $index): PersistentList<Tv> {
+        if ($index < 0 || $index >= $this->count) {
+            throw new OutOfBoundsException(sprintf('Index %s is out of bounds', $index));
+        }
+
+        if ($index === $this->count - 1) {
+            return $this->pop();
+        }
+
+        $values = $this->toVector();
+        $values->removeKey($index);
+
+        return new static($values);
+    }
+
+    /**
+     * Return a new list with the value at the specified index replaced.
+     *
+     * @param int $index
+     * @param Tv $value
+     * @return \Titon\Type\PersistentList<Tv>
+     * @throws \OutOfBoundsException
+     */
+    public function set(int $index, Tv $value): PersistentList<Tv> {
+        $count = $this->count;
+
+        if ($index === $count) {
+            return $this->append($value);
+
+        } else if ($index < 0 || $index > $count) {
+            throw new OutOfBoundsException(sprintf('Index %s is out of bounds', $index));
+        }
+
+        // Within the tail
+        if ($index >= static::tailOffset($count)) {
+            $tail = $this->tail->toVector();
+            $tail[$index & static::MASK] = $value;
+
+            return $this->derive($count, $this->shift, $this->root, $tail);
+        }
+
+        return $this->derive($count, $this->shift, $this->assoc($this->shift, $this->root, $index, $value), $this->tail);
+    }
+
+    /**
+     * Return the values as an array.
+     *
+     * @return array<int, Tv>
+     */
+    public function toArray(): array<int, Tv> {
+        $array = [];
+
+        foreach ($this->getIterator() as $value) {
+            $array[] = $value;
+        }
+
+        return $array;
+    }
+
+    /**
+     * Return the values as an ArrayList.
+     *
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    public function toArrayList(): ArrayList<Tv> {
+        return new ArrayList($this->toVector());
+    }
+
+    /**
+     * Return the values as a vector.
+     *
+     * @return Vector<Tv>
+     */
+    public function toVector(): Vector<Tv> {
+        $vector = Vector {};
+        $vector->reserve($this->count);
+
+        foreach ($this->getIterator() as $value) {
+            $vector[] = $value;
+        }
+
+        return $vector;
+    }
+
+    /**
+     * Create a node that leads to the node through a single path of branches.
+     *
+     * @param int $level
+     * @param Vector<mixed> $node
+     * @return Vector<mixed>
+     */
+    protected static function newPath(int $level, Vector<mixed> $node): Vector<mixed> {
+        if ($level === 0) {
+            return $node;
+        }
+
+        return Vector {static::newPath($level - static::BITS, $node)};
+    }
+
+    /**
+     * Return the index of the first value in the tail.
+     *
+     * @param int $count
+     * @return int
+     */
+    protected static function tailOffset(int $count): int {
+        if ($count < static::WIDTH) {
+            return 0;
+        }
+
+        return (($count - 1) >> static::BITS) << static::BITS;
+    }
+
+    /**
+     * Return a copy of the path to the index with the value replaced.
+     *
+     * @param int $level
+     * @param Vector<mixed> $node
+     * @param int $index
+     * @param Tv $value
+     * @return Vector<mixed>
+     */
+    protected function assoc(int $level, Vector<mixed> $node, int $index, Tv $value): Vector<mixed> {
+        // UNSAFE
+        // Child nodes are stored untyped within the trie
+        $copy = $node->toVector();
+
+        if ($level === 0) {
+            $copy[$index & static::MASK] = $value;
+        } else {
+            $position = ($index >> $level) & static::MASK;
+            $copy[$position] = $this->assoc($level - static::BITS, $node[$position], $index, $value);
+        }
+
+        return $copy;
+    }
+
+    /**
+     * Return a new list that uses the defined trie, sharing nodes with this list.
+     *
+     * @param int $count
+     * @param int $shift
+     * @param Vector<mixed> $root
+     * @param Vector<Tv> $tail
+     * @return \Titon\Type\PersistentList<Tv>
+     */
+    protected function derive(int $count, int $shift, Vector<mixed> $root, Vector<Tv> $tail): PersistentList<Tv> {
+        $list = new static();
+        $list->count = $count;
+        $list->shift = $shift;
+        $list->root = $root;
+        $list->tail = $tail;
+
+        return $list;
+    }
+
+    /**
+     * Return the leaf node (or tail) that contains the index.
+     *
+     * @param int $index
+     * @return Vector<Tv>
+     */
+    protected function leafFor(int $index): Vector<Tv> {
+        // UNSAFE
+        // Child nodes are stored untyped within the trie
+        if ($index >= static::tailOffset($this->count)) {
+            return $this->tail;
+        }
+
+        $node = $this->root;
+
+        for ($level = $this->shift; $level > 0; $level -= static::BITS) {
+            $node = $node[($index >> $level) & static::MASK];
+        }
+
+        return $node;
+    }
+
+    /**
+     * Return a copy of the path to the last leaf with that leaf removed, or null if the node becomes empty.
+     *
+     * @param int $level
+     * @param Vector<mixed> $node
+     * @return ?Vector<mixed>
+     */
+    protected function popTail(int $level, Vector<mixed> $node): ?Vector<mixed> {
+        // UNSAFE
+        // Child nodes are stored untyped within the trie
+        $position = (($this->count - 2) >> $level) & static::MASK;
+
+        if ($level > static::BITS) {
+            $child = $this->popTail($level - static::BITS, $node[$position]);
+
+            if ($child === null && $position === 0) {
+                return null;
+            }
+
+            $copy = $node->toVector();
+
+            if ($child === null) {
+                $copy->pop();
+            } else {
+                $copy[$position] = $child;
+            }
+
+            return $copy;
+
+        } else if ($position === 0) {
+            return null;
+        }
+
+        $copy = $node->toVector();
+        $copy->pop();
+
+        return $copy;
+    }
+
+    /**
+     * Return a copy of the path to the end of the trie with the full tail added as a new leaf.
+     *
+     * @param int $level
+     * @param Vector<mixed> $parent
+     * @param Vector<mixed> $tail
+     * @return Vector<mixed>
+     */
+    protected function pushTail(int $level, Vector<mixed> $parent, Vector<mixed> $tail): Vector<mixed> {
+        // UNSAFE
+        // Child nodes are stored untyped within the trie
+        $position = (($this->count - 1) >> $level) & static::MASK;
+        $copy = $parent->toVector();
+
+        if ($level === static::BITS) {
+            $node = $tail;
+        } else {
+            $child = $parent->get($position);
+            $node = ($child !== null) ? $this->pushTail($level - static::BITS, $child, $tail) : static::newPath($level - static::BITS, $tail);
+        }
+
+        if ($position < $copy->count()) {
+            $copy[$position] = $node;
+        } else {
+            $copy[] = $node;
+        }
+
+        return $copy;
+    }
+
+}
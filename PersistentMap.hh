@@ -0,0 +1,506 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+use Titon\Common\Arrayable;
+use Titon\Common\Mapable;
+use \Countable;
+use \IteratorAggregate;
+use \OutOfBoundsException;
+
+/**
+ * The PersistentMap is an immutable map with structural sharing, implemented as a hash array mapped trie.
+ * Keys are hashed into 32 bits, and each level of the trie uses 5 bits of the hash to select a child.
+ * Every modification returns a new map that shares all untouched nodes with the original, so setting
+ * and removing only copy the nodes along a single path, which is O(log32 n) instead of a full copy.
+ *
+ * Branch nodes are stored as sparse maps of child positions, leaves as key-value pairs,
+ * and keys with identical hashes are stored within a collision bucket at the bottom of the trie.
+ * Since pairs are organized by hash, iteration order is not the insertion order.
+ *
+ * @package Titon\Type
+ */
+class PersistentMap<Tk as arraykey, Tv> implements
+    IteratorAggregate<Tv>,
+    Countable,
+    Arrayable<Tk, Tv>,
+    Mapable<Tk, Tv> {
+
+    const int BITS = 5;
+    const int MASK = 31;
+    const int MAX_SHIFT = 30;
+
+    /**
+     * Number of pairs in the map.
+     *
+     * @var int
+     */
+    protected int $count = 0;
+
+    /**
+     * Root node of the trie.
+     *
+     * @var Map<int, mixed>
+     */
+    protected Map<int, mixed> $root = Map {};
+
+    /**
+     * Build the map from a list of pairs.
+     *
+     * @param KeyedTraversable<Tk, Tv> $pairs
+     */
+    final public function __construct(KeyedTraversable<Tk, Tv> $pairs = Map {}) {
+        $root = $this->root;
+        $count = 0;
+
+        foreach ($pairs as $key => $value) {
+            list($root, $added) = static::assoc($root, 0, static::hash($key), $key, $value);
+
+            if ($added) {
+                $count++;
+            }
+        }
+
+        $this->root = $root;
+        $this->count = $count;
+    }
+
+    /**
+     * Return the value for the key or throw an exception.
+     *
+     * @param Tk $key
+     * @return Tv
+     * @throws \OutOfBoundsException
+     */
+    public function at(Tk $key): Tv {
+        $pair = $this->find($key);
+
+        if ($pair === null) {
+            throw new OutOfBoundsException(sprintf('Key %s does not exist', $key));
+        }
+
+        return $pair[1];
+    }
+
+    /**
+     * Return true if the key exists.
+     *
+     * @param Tk $key
+     * @return bool
+     */
+    public function contains(Tk $key): bool {
+        return ($this->find($key) !== null);
+    }
+
+    /**
+     * Return the number of pairs.
+     *
+     * @return int
+     */
+    public function count(): int {
+        return $this->count;
+    }
+
+    /**
+     * Return the value for the key or null if it does not exist.
+     *
+     * @param Tk $key
+     * @return ?Tv
+     */
+    public function get(Tk $key): ?Tv {
+        $pair = $this->find($key);
+
+        return ($pair === null) ? null : $pair[1];
+    }
+
+    /**
+     * Return an iterator that walks the trie depth first.
+     *
+     * @return KeyedIterator<Tk, Tv>
+     */
+    public function getIterator(): KeyedIterator<Tk, Tv> {
+        // UNSAFE
+        // Child nodes are stored untyped within the trie
+        $stack = Vector {$this->root};
+
+        while (!$stack->isEmpty()) {
+            foreach ($stack->pop() as $child) {
+                if ($child instanceof Pair) {
+                    yield $child[0] => $child[1];
+
+                } else if ($child instanceof Map) {
+                    $stack[] = $child;
+
+                } else {
+                    foreach ($child as $pair) {
+                        yield $pair[0] => $pair[1];
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Return true if the map is empty.
+     *
+     * @return bool
+     */
+    public function isEmpty(): bool {
+        return ($this->count === 0);
+    }
+
+    /**
+     * Return all the keys.
+     *
+     * @return Vector<Tk>
+     */
+    public function keys(): Vector<Tk> {
+        $keys = Vector {};
+        $keys->reserve($this->count);
+
+        foreach ($this->getIterator() as $key => $value) {
+            $keys[] = $key;
+        }
+
+        return $keys;
+    }
+
+    /**
+     * Return a new map with the pairs merged in. Existing keys are overwritten.
+     *
+     * @param KeyedTraversable<Tk, Tv> $pairs
+     * @return \Titon\Type\PersistentMap<Tk, Tv>
+     */
+    public function merge(KeyedTraversable<Tk, Tv> $pairs): PersistentMap<Tk, Tv> {
+        $root = $this->root;
+        $count = $this->count;
+
+        foreach ($pairs as $key => $value) {
+            list($root, $added) = static::assoc($root, 0, static::hash($key), $key, $value);
+
+            if ($added) {
+                $count++;
+            }
+        }
+
+        return $this->derive($count, $root);
+    }
+
+    /**
+     * Return a new map without the key. If the key does not exist, the current map is returned.
+     *
+     * @param Tk $key
+     * @return \Titon\Type\PersistentMap<Tk, Tv>
+     */
+    public function remove(Tk $key): PersistentMap<Tk, Tv> {
+        $root = static::dissoc($this->root, 0, static::hash($key), $key);
+
+        if ($root === null) {
+            return $this;
+        }
+
+        return $this->derive($this->count - 1, $root);
+    }
+
+    /**
+     * Return a new map with the value set for the key.
+     *
+     * @param Tk $key
+     * @param Tv $value
+     * @return \Titon\Type\PersistentMap<Tk, Tv>
+     */
+    public function set(Tk $key, Tv $value): PersistentMap<Tk, Tv> {
+        list($root, $added) = static::assoc($this->root, 0, static::hash($key), $key, $value);
+
+        if ($root === $this->root) {
+            return $this;
+        }
+
+        return $this->derive($added ? $this->count + 1 : $this->count, $root);
+    }
+
+    /**
+     * Return the pairs as an array.
+     *
+     * @return array<Tk, Tv>
+     */
+    public function toArray(): array<Tk, Tv> {
+        $array = [];
+
+        foreach ($this->getIterator() as $key => $value) {
+            $array[$key] = $value;
+        }
+
+        return $array;
+    }
+
+    /**
+     * Return the pairs as a HashMap.
+     *
+     * @return \Titon\Type\HashMap<Tk, Tv>
+     */
+    public function toHashMap(): HashMap<Tk, Tv> {
+        return new HashMap($this->toMap());
+    }
+
+    /**
+     * Return the pairs as a map.
+     *
+     * @return Map<Tk, Tv>
+     */
+    public function toMap(): Map<Tk, Tv> {
+        $map = Map {};
+        $map->reserve($this->count);
+
+        foreach ($this->getIterator() as $key => $value) {
+            $map[$key] = $value;
+        }
+
+        return $map;
+    }
+
+    /**
+     * Return all the values.
+     *
+     * @return Vector<Tv>
+     */
+    public function values(): Vector<Tv> {
+        $values = Vector {};
+        $values->reserve($this->count);
+
+        foreach ($this->getIterator() as $value) {
+            $values[] = $value;
+        }
+
+        return $values;
+    }
+
+    /**
+     * Return a copy of the path to the key with the value set, and whether a new key was added.
+     * If the key already has the same value, the node itself is returned.
+     *
+     * @param Map<int, mixed> $node
+     * @param int $shift
+     * @param int $hash
+     * @param Tk $key
+     * @param Tv $value
+     * @return Pair<Map<int, mixed>, bool>
+     */
+    protected static function assoc(Map<int, mixed> $node, int $shift, int $hash, Tk $key, Tv $value): Pair<Map<int, mixed>, bool> {
+        // UNSAFE
+        // Child nodes are stored untyped within the trie
+        $position = ($hash >> $shift) & static::MASK;
+        $child = $node->get($position);
+        $added = true;
+
+        if ($child === null) {
+            $child = Pair {$key, $value};
+
+        } else if ($child instanceof Pair) {
+            if ($child[0] === $key) {
+                if ($child[1] === $value) {
+                    return Pair {$node, false};
+                }
+
+                $child = Pair {$key, $value};
+                $added = false;
+
+            } else {
+                $child = static::split($shift + static::BITS, $child, static::hash($child[0]), Pair {$key, $value}, $hash);
+            }
+
+        } else if ($child instanceof Map) {
+            list($branch, $added) = static::assoc($child, $shift + static::BITS, $hash, $key, $value);
+
+            if ($branch === $child) {
+                return Pair {$node, false};
+            }
+
+            $child = $branch;
+
+        } else {
+            $bucket = $child->toVector();
+
+            foreach ($bucket as $i => $pair) {
+                if ($pair[0] === $key) {
+                    if ($pair[1] === $value) {
+                        return Pair {$node, false};
+                    }
+
+                    $bucket[$i] = Pair {$key, $value};
+                    $added = false;
+                    break;
+                }
+            }
+
+            if ($added) {
+                $bucket[] = Pair {$key, $value};
+            }
+
+            $child = $bucket;
+        }
+
+        $copy = $node->toMap();
+        $copy[$position] = $child;
+
+        return Pair {$copy, $added};
+    }
+
+    /**
+     * Return a copy of the path to the key with the key removed, or null if the key does not exist.
+     * Branches and buckets that are left with a single pair are collapsed into that pair.
+     *
+     * @param Map<int, mixed> $node
+     * @param int $shift
+     * @param int $hash
+     * @param Tk $key
+     * @return ?Map<int, mixed>
+     */
+    protected static function dissoc(Map<int, mixed> $node, int $shift, int $hash, Tk $key): ?Map<int, mixed> {
+        // UNSAFE
+        // Child nodes are stored untyped within the trie
+        $position = ($hash >> $shift) & static::MASK;
+        $child = $node->get($position);
+
+        if ($child === null) {
+            return null;
+
+        } else if ($child instanceof Pair) {
+            if ($child[0] !== $key) {
+                return null;
+            }
+
+            $child = null;
+
+        } else if ($child instanceof Map) {
+            $child = static::dissoc($child, $shift + static::BITS, $hash, $key);
+
+            if ($child === null) {
+                return null;
+            }
+
+            if ($child->isEmpty()) {
+                $child = null;
+
+            } else if ($child->count() === 1 && ($only = $child->firstValue()) instanceof Pair) {
+                $child = $only;
+            }
+
+        } else {
+            $bucket = $child->filter($pair ==> $pair[0] !== $key);
+
+            if ($bucket->count() === $child->count()) {
+                return null;
+            }
+
+            $child = ($bucket->count() === 1) ? $bucket[0] : $bucket;
+        }
+
+        $copy = $node->toMap();
+
+        if ($child === null) {
+            $copy->remove($position);
+        } else {
+            $copy[$position] = $child;
+        }
+
+        return $copy;
+    }
+
+    /**
+     * Hash a key into 32 bits. Integers use their own bits, while strings use a CRC32 checksum.
+     *
+     * @param Tk $key
+     * @return int
+     */
+    protected static function hash(Tk $key): int {
+        if (is_int($key)) {
+            return ($key ^ ($key >> 32)) & 0xFFFFFFFF;
+        }
+
+        return crc32((string) $key);
+    }
+
+    /**
+     * Create the branches that separate two pairs whose hashes share the same bits up to the shift.
+     * Once the hash bits are exhausted, the pairs are stored in a collision bucket.
+     *
+     * @param int $shift
+     * @param Pair<Tk, Tv> $a
+     * @param int $hashA
+     * @param Pair<Tk, Tv> $b
+     * @param int $hashB
+     * @return mixed
+     */
+    protected static function split(int $shift, Pair<Tk, Tv> $a, int $hashA, Pair<Tk, Tv> $b, int $hashB): mixed {
+        if ($shift > static::MAX_SHIFT) {
+            return Vector {$a, $b};
+        }
+
+        $positionA = ($hashA >> $shift) & static::MASK;
+        $positionB = ($hashB >> $shift) & static::MASK;
+
+        if ($positionA === $positionB) {
+            return Map {$positionA => static::split($shift + static::BITS, $a, $hashA, $b, $hashB)};
+        }
+
+        return Map {$positionA => $a, $positionB => $b};
+    }
+
+    /**
+     * Return a new map that uses the defined trie, sharing nodes with this map.
+     *
+     * @param int $count
+     * @param Map<int, mixed> $root
+     * @return \Titon\Type\PersistentMap<Tk, Tv>
+     */
+    protected function derive(int $count, Map<int, mixed> $root): PersistentMap<Tk, Tv> {
+        $map = new static();
+        $map->count = $count;
+        $map->root = $root;
+
+        return $map;
+    }
+
+    /**
+     * Return the pair for the key or null if it does not exist.
+     *
+     * @param Tk $key
+     * @return ?Pair<Tk, Tv>
+     */
+    protected function find(Tk $key): ?Pair<Tk, Tv> {
+        // UNSAFE
+        // Child nodes are stored untyped within the trie
+        $hash = static::hash($key);
+        $node = $this->root;
+
+        for ($shift = 0; ; $shift += static::BITS) {
+            $child = $node->get(($hash >> $shift) & static::MASK);
+
+            if ($child === null) {
+                return null;
+
+            } else if ($child instanceof Pair) {
+                return ($child[0] === $key) ? $child : null;
+
+            } else if ($child instanceof Map) {
+                $node = $child;
+
+            } else {
+                foreach ($child as $pair) {
+                    if ($pair[0] === $key) {
+                        return $pair;
+                    }
+                }
+
+                return null;
+            }
+        }
+    }
+
+}
@@ -0,0 +1,147 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+/**
+ * The Profiler records how often type operations are called and how much data they copy, per class and method.
+ * It is disabled by default. Instrumented methods check the `$enabled` flag before measuring or timing anything,
+ * so a disabled profiler costs a single property read per operation.
+ *
+ * The following is recorded for each operation:
+ *
+ *  - calls: Number of times the operation was called.
+ *  - elements: Number of collection elements copied into a new collection or array.
+ *  - bytes: Number of string bytes copied.
+ *  - callbacks: Number of user callback invocations.
+ *  - time: Wall time spent within the operation, in seconds.
+ *
+ * @package Titon\Type
+ */
+class Profiler {
+
+    /**
+     * Whether operations should be recorded.
+     *
+     * @var bool
+     */
+    public static bool $enabled = false;
+
+    /**
+     * Recorded entries, mapped by class and method.
+     *
+     * @var Map<string, \Titon\Type\ProfileEntry>
+     */
+    protected static Map<string, ProfileEntry> $entries = Map {};
+
+    /**
+     * Return the name of the method that called the method that is being recorded.
+     * Used by internal copy points, like `detach()`, to attribute the copy to the public method that caused it.
+     * If the copy point was called from outside the class, the name of the copy point is returned.
+     * Calls dispatched through `__call()` are attributed to the proxied method.
+     *
+     * @return string
+     */
+    public static function caller(): string {
+        // UNSAFE
+        // Backtrace frames are untyped arrays
+        // Frames: this method, the instrumented method, and its caller
+        $trace = debug_backtrace(DEBUG_BACKTRACE_IGNORE_ARGS, 3);
+        $method = $trace[1]['function'];
+
+        if (isset($trace[2]['class']) && is_a($trace[2]['class'], $trace[1]['class'], true)) {
+            $method = $trace[2]['function'];
+
+            // Arguments are only collected when needed, as the proxied method is the first argument
+            if ($method === '__call') {
+                $trace = debug_backtrace(0, 3);
+                $method = (string) $trace[2]['args'][0];
+            }
+        }
+
+        return $method;
+    }
+
+    /**
+     * Stop recording operations. Recorded entries are kept until reset.
+     */
+    public static function disable(): void {
+        static::$enabled = false;
+    }
+
+    /**
+     * Start recording operations.
+     */
+    public static function enable(): void {
+        static::$enabled = true;
+    }
+
+    /**
+     * Return true if operations are being recorded.
+     *
+     * @return bool
+     */
+    public static function isEnabled(): bool {
+        return static::$enabled;
+    }
+
+    /**
+     * Record a call to an operation. If a start time from `microtime(true)` is defined,
+     * the time elapsed since then is added to the operation.
+     *
+     * @param string $class
+     * @param string $method
+     * @param int $elements
+     * @param int $bytes
+     * @param int $callbacks
+     * @param float $start
+     */
+    public static function record(string $class, string $method, int $elements = 0, int $bytes = 0, int $callbacks = 0, float $start = 0.0): void {
+        $id = $class . '::' . $method;
+        $entry = static::$entries->get($id) ?: shape(
+            'class' => $class,
+            'method' => $method,
+            'calls' => 0,
+            'elements' => 0,
+            'bytes' => 0,
+            'callbacks' => 0,
+            'time' => 0.0
+        );
+
+        $entry['calls']++;
+        $entry['elements'] += $elements;
+        $entry['bytes'] += $bytes;
+        $entry['callbacks'] += $callbacks;
+
+        if ($start > 0.0) {
+            $entry['time'] += microtime(true) - $start;
+        }
+
+        static::$entries[$id] = $entry;
+    }
+
+    /**
+     * Return a snapshot of all recorded entries, mapped by class and method, sorted by the most calls first.
+     *
+     * @return Map<string, \Titon\Type\ProfileEntry>
+     */
+    public static function report(): Map<string, ProfileEntry> {
+        $entries = static::$entries->toArray();
+
+        uasort($entries, ($a, $b) ==> $b['calls'] - $a['calls']);
+
+        return new Map($entries);
+    }
+
+    /**
+     * Remove all recorded entries.
+     */
+    public static function reset(): void {
+        static::$entries = Map {};
+    }
+
+}
@@ -0,0 +1,58 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+/**
+ * The RefCount tracks how many wrappers share the same internal collection. It allows a collection
+ * to be shared between wrappers (copy-on-write) and only be copied once a shared wrapper is modified.
+ *
+ * @package Titon\Type
+ */
+final class RefCount {
+
+    /**
+     * Number of wrappers currently sharing the collection.
+     *
+     * @var int
+     */
+    protected int $count = 1;
+
+    /**
+     * Register an additional wrapper that shares the collection.
+     *
+     * @return $this
+     */
+    public function acquire(): this {
+        ++$this->count;
+
+        return $this;
+    }
+
+    /**
+     * Return true if the collection is shared by more than one wrapper.
+     *
+     * @return bool
+     */
+    public function isShared(): bool {
+        return ($this->count > 1);
+    }
+
+    /**
+     * Unregister a wrapper that no longer shares the collection.
+     *
+     * @return $this
+     */
+    public function release(): this {
+        if ($this->count > 0) {
+            --$this->count;
+        }
+
+        return $this;
+    }
+
+}
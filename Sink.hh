@@ -0,0 +1,33 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+/**
+ * A Sink is a destination that serializers can incrementally write output to,
+ * like an in-memory buffer or a stream, instead of building and returning one large string.
+ *
+ * @package Titon\Type
+ */
+interface Sink {
+
+    /**
+     * Push any buffered output to the underlying destination.
+     *
+     * @return $this
+     */
+    public function flush(): this;
+
+    /**
+     * Append data to the sink.
+     *
+     * @param string $data
+     * @return $this
+     */
+    public function write(string $data): this;
+
+}
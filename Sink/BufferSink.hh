@@ -0,0 +1,74 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Sink;
+
+use Titon\Type\Sink;
+
+/**
+ * The BufferSink collects all written output into a single in-memory string.
+ *
+ * @package Titon\Type\Sink
+ */
+class BufferSink implements Sink {
+
+    /**
+     * The output written so far.
+     *
+     * @var string
+     */
+    protected string $buffer = '';
+
+    /**
+     * Return the buffered output.
+     *
+     * @return string
+     */
+    public function __toString(): string {
+        return $this->toString();
+    }
+
+    /**
+     * Output is kept in memory, so there is nothing to flush.
+     *
+     * @return $this
+     */
+    public function flush(): this {
+        return $this;
+    }
+
+    /**
+     * Return the amount of bytes written.
+     *
+     * @return int
+     */
+    public function length(): int {
+        return strlen($this->buffer);
+    }
+
+    /**
+     * Return the buffered output.
+     *
+     * @return string
+     */
+    public function toString(): string {
+        return $this->buffer;
+    }
+
+    /**
+     * Append data to the buffer.
+     *
+     * @param string $data
+     * @return $this
+     */
+    public function write(string $data): this {
+        $this->buffer .= $data;
+
+        return $this;
+    }
+
+}
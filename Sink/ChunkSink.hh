@@ -0,0 +1,104 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Sink;
+
+use Titon\Type\Sink;
+
+/**
+ * The ChunkSink groups written output into chunks of at least the chunk size and queues them until they are drained.
+ * It lets a synchronous serializer produce output that an asynchronous consumer writes chunk by chunk,
+ * so only the queued chunks are held in memory.
+ *
+ * @package Titon\Type\Sink
+ */
+class ChunkSink implements Sink {
+
+    /**
+     * Output that has not filled a chunk yet.
+     *
+     * @var string
+     */
+    protected string $buffer = '';
+
+    /**
+     * Amount of bytes in each chunk.
+     *
+     * @var int
+     */
+    protected int $chunkSize;
+
+    /**
+     * Chunks waiting to be drained.
+     *
+     * @var Vector<string>
+     */
+    protected Vector<string> $chunks = Vector {};
+
+    /**
+     * Set the chunk size.
+     *
+     * @param int $chunkSize
+     */
+    public function __construct(int $chunkSize = 8192) {
+        $this->chunkSize = max($chunkSize, 1);
+    }
+
+    /**
+     * Return the queued chunks and empty the queue.
+     *
+     * @return Vector<string>
+     */
+    public function drain(): Vector<string> {
+        $chunks = $this->chunks;
+
+        $this->chunks = Vector {};
+
+        return $chunks;
+    }
+
+    /**
+     * Queue the remaining output as a final, possibly smaller, chunk.
+     *
+     * @return $this
+     */
+    public function flush(): this {
+        if ($this->buffer !== '') {
+            $this->chunks[] = $this->buffer;
+            $this->buffer = '';
+        }
+
+        return $this;
+    }
+
+    /**
+     * Return true if there are chunks waiting to be drained.
+     *
+     * @return bool
+     */
+    public function hasChunks(): bool {
+        return !$this->chunks->isEmpty();
+    }
+
+    /**
+     * Append data to the buffer, and queue it as a chunk once the chunk size is reached.
+     *
+     * @param string $data
+     * @return $this
+     */
+    public function write(string $data): this {
+        $this->buffer .= $data;
+
+        if (strlen($this->buffer) >= $this->chunkSize) {
+            $this->chunks[] = $this->buffer;
+            $this->buffer = '';
+        }
+
+        return $this;
+    }
+
+}
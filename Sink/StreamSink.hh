@@ -0,0 +1,111 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Sink;
+
+use Titon\Type\Exception\StreamException;
+use Titon\Type\Sink;
+
+/**
+ * The StreamSink writes output to a stream resource (file, socket, php://output, etc) in chunks,
+ * so that only a single chunk is ever held in memory.
+ *
+ * @package Titon\Type\Sink
+ */
+class StreamSink implements Sink {
+
+    /**
+     * Output waiting to be written to the stream.
+     *
+     * @var string
+     */
+    protected string $buffer = '';
+
+    /**
+     * Amount of bytes to buffer before writing to the stream.
+     *
+     * @var int
+     */
+    protected int $chunkSize;
+
+    /**
+     * The stream to write to.
+     *
+     * @var resource
+     */
+    protected resource $stream;
+
+    /**
+     * Set the stream and chunk size.
+     *
+     * @param resource $stream
+     * @param int $chunkSize
+     */
+    public function __construct(resource $stream, int $chunkSize = 8192) {
+        $this->stream = $stream;
+        $this->chunkSize = $chunkSize;
+    }
+
+    /**
+     * Write any remaining output before the sink is destroyed. This is best-effort, as exceptions can not
+     * be thrown from a destructor, so `flush()` should be called explicitly when write failures matter.
+     */
+    public function __destruct(): void {
+        try {
+            $this->flush();
+        } catch (StreamException $e) {
+            // The stream no longer accepts data, so the remaining output is discarded
+        }
+    }
+
+    /**
+     * Write the buffered output to the stream. Partial writes are retried until the whole buffer is written.
+     * If the stream stops accepting data, the remaining output is kept in the buffer.
+     *
+     * @return $this
+     * @throws \Titon\Type\Exception\StreamException
+     */
+    public function flush(): this {
+        while ($this->buffer !== '') {
+            $written = fwrite($this->stream, $this->buffer);
+
+            if ($written === false || $written === 0) {
+                throw new StreamException(sprintf('Failed to write %s bytes to the stream', strlen($this->buffer)));
+            }
+
+            $this->buffer = (string) substr($this->buffer, $written);
+        }
+
+        return $this;
+    }
+
+    /**
+     * Return the stream resource.
+     *
+     * @return resource
+     */
+    public function getStream(): resource {
+        return $this->stream;
+    }
+
+    /**
+     * Append data to the buffer, and write it to the stream once the chunk size is reached.
+     *
+     * @param string $data
+     * @return $this
+     */
+    public function write(string $data): this {
+        $this->buffer .= $data;
+
+        if (strlen($this->buffer) >= $this->chunkSize) {
+            $this->flush();
+        }
+
+        return $this;
+    }
+
+}
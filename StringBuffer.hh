@@ -7,6 +7,7 @@
 
 namespace Titon\Type;
 
+use Titon\Type\StringBuffer\Matcher;
 use Titon\Utility\Inflect;
 use Titon\Utility\Sanitize;
 use Titon\Utility\Str;
@@ -33,6 +34,10 @@ class StringBuffer implements Serializable {
      * @param string $value
      */
     final public function __construct(string $value = '') {
+        if (Profiler::$enabled) {
+            Profiler::record(static::class, Profiler::caller(), 0, strlen($value));
+        }
+
         $this->write($value);
     }
 
@@ -55,6 +60,17 @@ class StringBuffer implements Serializable {
         return new static($this->value() . $value);
     }
 
+    /**
+     * Return a mutable StringBuilder starting with the current value, for append heavy workloads.
+     * A capacity hint for the expected number of appends can be defined.
+     *
+     * @param int $capacity
+     * @return \Titon\Type\StringBuilder
+     */
+    public function builder(int $capacity = 0): StringBuilder {
+        return new StringBuilder($this->value(), $capacity);
+    }
+
     /**
      * Upper case the first letter of the first word.
      *
@@ -99,6 +115,19 @@ class StringBuffer implements Serializable {
         return Str::compare($this->value(), $value, $length);
     }
 
+    /**
+     * Compile a reusable matcher for a list of needles, which can be used to search for all needles in a single pass.
+     *
+     * @uses Titon\Type\StringBuffer\Matcher
+     *
+     * @param Traversable<string> $needles
+     * @param bool $caseSensitive
+     * @return \Titon\Type\StringBuffer\Matcher
+     */
+    public static function compileNeedles(Traversable<string> $needles, bool $caseSensitive = true): Matcher {
+        return new Matcher($needles, $caseSensitive);
+    }
+
     /**
      * Concatenate two strings and return a new string object.
      *
@@ -128,6 +157,16 @@ class StringBuffer implements Serializable {
         return Str::contains($this->value(), $needle, $strict, $offset);
     }
 
+    /**
+     * Check to see if any of the compiled needles exist within this string.
+     *
+     * @param \Titon\Type\StringBuffer\Matcher $matcher
+     * @return bool
+     */
+    public function containsAny(Matcher $matcher): bool {
+        return $matcher->containsAny($this->value());
+    }
+
     /**
      * Checks to see if the string ends with a specific value.
      *
@@ -189,6 +228,16 @@ class StringBuffer implements Serializable {
         return Str::indexOf($this->value(), $needle, $strict, $offset);
     }
 
+    /**
+     * Grab the byte index of the leftmost match of any of the compiled needles, or -1 if none match.
+     *
+     * @param \Titon\Type\StringBuffer\Matcher $matcher
+     * @return int
+     */
+    public function indexOfAny(Matcher $matcher): int {
+        return $matcher->indexOfAny($this->value());
+    }
+
     /**
      * Checks to see if the value is empty.
      *
@@ -221,6 +270,15 @@ class StringBuffer implements Serializable {
         return mb_strlen($this->value());
     }
 
+    /**
+     * Return a generator that yields a view for each line, without splitting the whole string upfront.
+     *
+     * @return Iterator<\Titon\Type\StringView>
+     */
+    public function lines(): Iterator<StringView> {
+        return $this->view()->lines();
+    }
+
     /**
      * Perform a regex pattern match.
      *
@@ -296,6 +354,18 @@ class StringBuffer implements Serializable {
         return new static(str_ireplace($search, $replace, $this->value()));
     }
 
+    /**
+     * Replace every match of the compiled needles with a new value in a single pass,
+     * instead of one `str_replace()` pass per needle.
+     *
+     * @param \Titon\Type\StringBuffer\Matcher $matcher
+     * @param string $replace
+     * @return \Titon\Type\StringBuffer
+     */
+    public function replaceAll(Matcher $matcher, string $replace = ''): StringBuffer {
+        return new static($matcher->replaceAll($this->value(), $replace));
+    }
+
     /**
      * Reverse the string.
      *
@@ -365,6 +435,16 @@ class StringBuffer implements Serializable {
         return new Vector($chars);
     }
 
+    /**
+     * Return a generator that yields a view for each token between delimiters, without splitting the whole string upfront.
+     *
+     * @param string $delimiter
+     * @return Iterator<\Titon\Type\StringView>
+     */
+    public function tokens(string $delimiter): Iterator<StringView> {
+        return $this->view()->tokens($delimiter);
+    }
+
     /**
      * Converts the string to a camel case form.
      *
@@ -481,6 +561,18 @@ class StringBuffer implements Serializable {
         return $this->value;
     }
 
+    /**
+     * Return a read-only view over a byte range of the string, which does not copy the string until it is converted.
+     * Unlike `extract()`, offsets and lengths are in bytes. If no length is defined, the view extends to the end.
+     *
+     * @param int $offset
+     * @param int $length
+     * @return \Titon\Type\StringView
+     */
+    public function view(int $offset = 0, ?int $length = null): StringView {
+        return new StringView($this->value(), $offset, $length);
+    }
+
     /**
      * Count how many words exist within the string.
      *
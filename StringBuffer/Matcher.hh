@@ -0,0 +1,343 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\StringBuffer;
+
+/**
+ * The Matcher is a compiled Aho-Corasick automaton for a fixed list of needles. Once compiled, a string can be
+ * searched for every needle in a single pass, in time proportional to the length of the string and the number
+ * of matches, regardless of how many needles there are. A matcher should be compiled once and reused.
+ *
+ * Needles are matched byte by byte. When matching case insensitively, ASCII letters are lowered.
+ *
+ * @package Titon\Type\StringBuffer
+ */
+class Matcher {
+
+    /**
+     * Whether needles are matched case sensitively.
+     *
+     * @var bool
+     */
+    protected bool $caseSensitive;
+
+    /**
+     * For each state, the nearest state along the failure links that ends a needle, or 0 if there is none.
+     *
+     * @var Vector<int>
+     */
+    protected Vector<int> $dictionary = Vector {0};
+
+    /**
+     * For each state, the state for the longest proper suffix that is also a prefix of a needle.
+     *
+     * @var Vector<int>
+     */
+    protected Vector<int> $failure = Vector {0};
+
+    /**
+     * For each state, the length of the needle that ends at it, or 0 if no needle ends at it.
+     *
+     * @var Vector<int>
+     */
+    protected Vector<int> $lengths = Vector {0};
+
+    /**
+     * Length of the longest needle.
+     *
+     * @var int
+     */
+    protected int $maxLength = 0;
+
+    /**
+     * The compiled needles.
+     *
+     * @var Vector<string>
+     */
+    protected Vector<string> $needles = Vector {};
+
+    /**
+     * For each state, the next state for each byte.
+     *
+     * @var Vector<Map<string, int>>
+     */
+    protected Vector<Map<string, int>> $transitions = Vector {Map {}};
+
+    /**
+     * Compile the automaton for a list of needles. Empty needles are ignored.
+     *
+     * @param Traversable<string> $needles
+     * @param bool $caseSensitive
+     */
+    public function __construct(Traversable<string> $needles, bool $caseSensitive = true) {
+        $this->caseSensitive = $caseSensitive;
+
+        foreach ($needles as $needle) {
+            if ($needle !== '') {
+                $this->needles[] = $needle;
+                $this->insert($caseSensitive ? $needle : strtolower($needle));
+            }
+        }
+
+        $this->link();
+    }
+
+    /**
+     * Return true if any needle exists within the subject.
+     *
+     * @param string $subject
+     * @return bool
+     */
+    public function containsAny(string $subject): bool {
+        $subject = $this->normalize($subject);
+        $state = 0;
+
+        for ($i = 0, $length = strlen($subject); $i < $length; $i++) {
+            $state = $this->step($state, $subject[$i]);
+
+            if ($this->lengths[$state] > 0 || $this->dictionary[$state] > 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Return all non-overlapping matches, mapped by their offset within the subject. When matches overlap,
+     * the leftmost match wins, and when multiple needles match at the same offset, the longest wins.
+     *
+     * @param string $subject
+     * @return Map<int, string>
+     */
+    public function findAll(string $subject): Map<int, string> {
+        $matches = Map {};
+        $offset = 0;
+
+        foreach ($this->scan($subject) as $start => $length) {
+            if ($start >= $offset) {
+                $matches[$start] = substr($subject, $start, $length);
+                $offset = $start + $length;
+            }
+        }
+
+        return $matches;
+    }
+
+    /**
+     * Return the compiled needles.
+     *
+     * @return Vector<string>
+     */
+    public function getNeedles(): Vector<string> {
+        return $this->needles->toVector();
+    }
+
+    /**
+     * Return the offset of the leftmost match of any needle, or -1 if no needle exists within the subject.
+     *
+     * @param string $subject
+     * @return int
+     */
+    public function indexOfAny(string $subject): int {
+        $subject = $this->normalize($subject);
+        $state = 0;
+        $index = -1;
+
+        for ($i = 0, $length = strlen($subject); $i < $length; $i++) {
+
+            // No match that ends later can start before the current match
+            if ($index >= 0 && ($i - $this->maxLength) >= $index) {
+                break;
+            }
+
+            $state = $this->step($state, $subject[$i]);
+
+            for ($match = $this->output($state); $match > 0; $match = $this->dictionary[$match]) {
+                $start = $i - $this->lengths[$match] + 1;
+
+                if ($index < 0 || $start < $index) {
+                    $index = $start;
+                }
+            }
+        }
+
+        return $index;
+    }
+
+    /**
+     * Return true if the needles are matched case sensitively.
+     *
+     * @return bool
+     */
+    public function isCaseSensitive(): bool {
+        return $this->caseSensitive;
+    }
+
+    /**
+     * Replace all non-overlapping matches with the replacement in a single pass.
+     * Overlapping matches are resolved the same as `findAll()`.
+     *
+     * @param string $subject
+     * @param string $replacement
+     * @return string
+     */
+    public function replaceAll(string $subject, string $replacement = ''): string {
+        return $this->replaceEach($subject, $match ==> $replacement);
+    }
+
+    /**
+     * Replace all non-overlapping matches with the return value of the callback, which receives the matched string.
+     *
+     * @param string $subject
+     * @param (function(string): string) $callback
+     * @return string
+     */
+    public function replaceEach(string $subject, (function(string): string) $callback): string {
+        $matches = $this->findAll($subject);
+
+        if ($matches->isEmpty()) {
+            return $subject;
+        }
+
+        $output = '';
+        $offset = 0;
+
+        foreach ($matches as $start => $match) {
+            $output .= substr($subject, $offset, $start - $offset) . $callback($match);
+            $offset = $start + strlen($match);
+        }
+
+        return $output . substr($subject, $offset);
+    }
+
+    /**
+     * Add a needle to the trie.
+     *
+     * @param string $needle
+     */
+    protected function insert(string $needle): void {
+        $state = 0;
+        $length = strlen($needle);
+
+        for ($i = 0; $i < $length; $i++) {
+            $char = $needle[$i];
+            $next = $this->transitions[$state]->get($char);
+
+            if ($next === null) {
+                $next = $this->transitions->count();
+
+                $this->transitions[] = Map {};
+                $this->lengths[] = 0;
+                $this->failure[] = 0;
+                $this->dictionary[] = 0;
+                $this->transitions[$state][$char] = $next;
+            }
+
+            $state = $next;
+        }
+
+        $this->lengths[$state] = $length;
+        $this->maxLength = max($this->maxLength, $length);
+    }
+
+    /**
+     * Build the failure and dictionary links in breadth first order, so that the links of shallower states
+     * are always built before the states that depend on them.
+     */
+    protected function link(): void {
+        $queue = Vector {};
+
+        foreach ($this->transitions[0] as $state) {
+            $queue[] = $state;
+        }
+
+        for ($i = 0; $i < $queue->count(); $i++) {
+            $parent = $queue[$i];
+
+            foreach ($this->transitions[$parent] as $char => $state) {
+                $queue[] = $state;
+
+                // Children of the root fail to the root, which is the default
+                $failure = $this->step($this->failure[$parent], $char);
+
+                $this->failure[$state] = $failure;
+                $this->dictionary[$state] = ($this->lengths[$failure] > 0) ? $failure : $this->dictionary[$failure];
+            }
+        }
+    }
+
+    /**
+     * Lower the subject when matching case insensitively. Lowering is byte based, so offsets are preserved.
+     *
+     * @param string $subject
+     * @return string
+     */
+    protected function normalize(string $subject): string {
+        return $this->caseSensitive ? $subject : strtolower($subject);
+    }
+
+    /**
+     * Return the first state that ends a needle, starting with the state itself, or 0 if there is none.
+     *
+     * @param int $state
+     * @return int
+     */
+    protected function output(int $state): int {
+        return ($this->lengths[$state] > 0) ? $state : $this->dictionary[$state];
+    }
+
+    /**
+     * Return the matches in the subject as a map of the offset to the length of the longest needle that starts there,
+     * sorted by offset.
+     *
+     * @param string $subject
+     * @return Map<int, int>
+     */
+    protected function scan(string $subject): Map<int, int> {
+        $subject = $this->normalize($subject);
+        $matches = Map {};
+        $state = 0;
+
+        for ($i = 0, $length = strlen($subject); $i < $length; $i++) {
+            $state = $this->step($state, $subject[$i]);
+
+            for ($match = $this->output($state); $match > 0; $match = $this->dictionary[$match]) {
+                $size = $this->lengths[$match];
+                $start = $i - $size + 1;
+
+                $current = $matches->get($start);
+
+                if ($current === null || $current < $size) {
+                    $matches[$start] = $size;
+                }
+            }
+        }
+
+        ksort($matches);
+
+        return $matches;
+    }
+
+    /**
+     * Return the next state for a byte, following failure links until a transition exists.
+     *
+     * @param int $state
+     * @param string $char
+     * @return int
+     */
+    protected function step(int $state, string $char): int {
+        $transitions = $this->transitions;
+
+        while ($state !== 0 && !$transitions[$state]->contains($char)) {
+            $state = $this->failure[$state];
+        }
+
+        return $transitions[$state]->get($char) ?? 0;
+    }
+
+}
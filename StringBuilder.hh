@@ -0,0 +1,184 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+/**
+ * The StringBuilder is a mutable companion to the StringBuffer, used for building large strings piece by piece.
+ * Appended strings are stored as separate chunks and are only joined once the final string is requested,
+ * which keeps every append (or prepend) constant in cost, regardless of how large the string has grown.
+ *
+ * @package Titon\Type
+ */
+class StringBuilder implements Sink {
+
+    /**
+     * Chunks appended to the end of the string.
+     *
+     * @var Vector<string>
+     */
+    protected Vector<string> $chunks = Vector {};
+
+    /**
+     * Chunks prepended to the beginning of the string, in reverse order.
+     *
+     * @var Vector<string>
+     */
+    protected Vector<string> $prefixes = Vector {};
+
+    /**
+     * Set the initial value and optionally reserve room for the expected number of appends.
+     *
+     * @param string $value
+     * @param int $capacity
+     */
+    public function __construct(string $value = '', int $capacity = 0) {
+        if ($capacity > 0) {
+            $this->chunks->reserve($capacity);
+        }
+
+        if ($value !== '') {
+            $this->chunks[] = $value;
+        }
+    }
+
+    /**
+     * Define magic to string.
+     *
+     * @return string
+     */
+    public function __toString(): string {
+        return $this->toString();
+    }
+
+    /**
+     * Append a string to the end of the builder.
+     *
+     * @param string $value
+     * @return $this
+     */
+    public function append(string $value): this {
+        if ($value !== '') {
+            $this->chunks[] = $value;
+        }
+
+        return $this;
+    }
+
+    /**
+     * Append a string followed by a new line to the end of the builder.
+     *
+     * @param string $value
+     * @return $this
+     */
+    public function appendLine(string $value = ''): this {
+        $this->chunks[] = $value . PHP_EOL;
+
+        return $this;
+    }
+
+    /**
+     * Empty the builder.
+     *
+     * @return $this
+     */
+    public function clear(): this {
+        $this->chunks->clear();
+        $this->prefixes->clear();
+
+        return $this;
+    }
+
+    /**
+     * The string is kept in memory, so there is nothing to flush.
+     *
+     * @return $this
+     */
+    public function flush(): this {
+        return $this;
+    }
+
+    /**
+     * Checks to see if the builder is empty.
+     *
+     * @return bool
+     */
+    public function isEmpty(): bool {
+        return ($this->chunks->isEmpty() && $this->prefixes->isEmpty());
+    }
+
+    /**
+     * Return the string length.
+     *
+     * @return int
+     */
+    public function length(): int {
+        return mb_strlen($this->toString());
+    }
+
+    /**
+     * Prepend a string to the beginning of the builder.
+     *
+     * @param string $value
+     * @return $this
+     */
+    public function prepend(string $value): this {
+        if ($value !== '') {
+            $this->prefixes[] = $value;
+        }
+
+        return $this;
+    }
+
+    /**
+     * Return a StringBuffer containing the built string.
+     *
+     * @return \Titon\Type\StringBuffer
+     */
+    public function toBuffer(): StringBuffer {
+        return new StringBuffer($this->toString());
+    }
+
+    /**
+     * Join all chunks and return the built string. The joined string replaces the chunks,
+     * so repeated calls without modifications do not join again.
+     *
+     * @return string
+     */
+    public function toString(): string {
+        $prefixes = $this->prefixes;
+        $chunks = $this->chunks;
+
+        if ($prefixes->isEmpty() && $chunks->count() <= 1) {
+            return $chunks->isEmpty() ? '' : $chunks[0];
+        }
+
+        $value = implode('', $chunks);
+
+        if (!$prefixes->isEmpty()) {
+            $prefixes->reverse();
+            $value = implode('', $prefixes) . $value;
+            $prefixes->clear();
+        }
+
+        $chunks->clear();
+        $chunks[] = $value;
+
+        return $value;
+    }
+
+    /**
+     * Alias for append(), allowing the builder to be used as a sink for serializers.
+     *
+     * @param string $data
+     * @return $this
+     */
+    public function write(string $data): this {
+        return $this->append($data);
+    }
+
+}
@@ -0,0 +1,53 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+/**
+ * The StringList is an extension of the ArrayList for lists of strings, like lists of slugs or codes.
+ * Since strings are hashable, lookups use the value index by default and duplicates are removed by hash.
+ * Strings are compared as strings when sorting and removing duplicates, so numeric strings like `"1"` and `"01"` differ.
+ *
+ * @package Titon\Type
+ */
+class StringList extends ArrayList<string> {
+
+    /**
+     * String lookups always use the value index.
+     *
+     * @var bool
+     */
+    protected bool $valueIndexed = true;
+
+    /**
+     * Sort the strings in the list using a custom callback or as strings.
+     *
+     * @param (function(string, string): int) $callback
+     * @param int $flags
+     * @return \Titon\Type\ArrayList<string>
+     */
+    public function sort(?(function(string, string): int) $callback = null, int $flags = SORT_STRING): ArrayList<string> {
+        return parent::sort($callback, $flags);
+    }
+
+    /**
+     * Removes duplicate strings from the list in a single pass, keeping the first occurrence.
+     * Strings are compared as strings (`SORT_STRING`) by default, which is the same as comparing them strictly.
+     *
+     * @param int $flags
+     * @param bool $strict
+     * @return \Titon\Type\ArrayList<string>
+     */
+    public function unique(int $flags = SORT_STRING, bool $strict = false): ArrayList<string> {
+        if (!$strict && $flags !== SORT_STRING) {
+            return parent::unique($flags);
+        }
+
+        return $this->wrap((new Set($this->value))->toVector());
+    }
+
+}
@@ -0,0 +1,293 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+/**
+ * The StringView is a lightweight read-only view over a byte range of a string. Since strings are shared
+ * by reference until modified, creating a view does not copy the source, and the range is only copied
+ * once the view is converted to a string, or searched while it ends before the source. Tokenizing a large payload
+ * into views keeps memory bounded by the size of the source.
+ *
+ * Offsets and lengths are in bytes, not characters.
+ *
+ * @package Titon\Type
+ */
+class StringView {
+
+    /**
+     * Amount of bytes in the view.
+     *
+     * @var int
+     */
+    protected int $length;
+
+    /**
+     * Byte offset in the source where the view begins.
+     *
+     * @var int
+     */
+    protected int $offset;
+
+    /**
+     * The string being viewed.
+     *
+     * @var string
+     */
+    protected string $source;
+
+    /**
+     * Set the source and the range to view. The range is clamped to the bounds of the source.
+     * If no length is defined, the view extends to the end of the source.
+     *
+     * @param string $source
+     * @param int $offset
+     * @param int $length
+     */
+    final public function __construct(string $source, int $offset = 0, ?int $length = null) {
+        $size = strlen($source);
+        $offset = min(max($offset, 0), $size);
+
+        $this->source = $source;
+        $this->offset = $offset;
+        $this->length = ($length === null) ? $size - $offset : min(max($length, 0), $size - $offset);
+    }
+
+    /**
+     * Define magic to string.
+     *
+     * @return string
+     */
+    public function __toString(): string {
+        return $this->toString();
+    }
+
+    /**
+     * Check to see if a string exists within the view.
+     *
+     * @param string $needle
+     * @return bool
+     */
+    public function contains(string $needle): bool {
+        return ($this->indexOf($needle) >= 0);
+    }
+
+    /**
+     * Checks to see if the view ends with a specific value.
+     *
+     * @param string $value
+     * @return bool
+     */
+    public function endsWith(string $value): bool {
+        $size = strlen($value);
+
+        if ($size === 0) {
+            return true;
+        }
+
+        return ($size <= $this->length && substr_compare($this->source, $value, $this->offset + $this->length - $size, $size) === 0);
+    }
+
+    /**
+     * Checks to see if the view and the value are equal, without copying the range.
+     *
+     * @param string $value
+     * @return bool
+     */
+    public function equals(string $value): bool {
+        return (strlen($value) === $this->length && $this->startsWith($value));
+    }
+
+    /**
+     * Return the byte offset in the source where the view begins.
+     *
+     * @return int
+     */
+    public function getOffset(): int {
+        return $this->offset;
+    }
+
+    /**
+     * Return the byte index of the first occurrence of the needle within the view, or -1 if it does not exist.
+     *
+     * @param string $needle
+     * @return int
+     */
+    public function indexOf(string $needle): int {
+        if (strlen($needle) > $this->length) {
+            return -1;
+        }
+
+        if (($this->offset + $this->length) === strlen($this->source)) {
+            $index = strpos($this->source, $needle, $this->offset);
+
+            return ($index === false) ? -1 : ($index - $this->offset);
+        }
+
+        // Search a copy of the view, so that the search can not scan past the end of the view
+        $index = strpos((string) substr($this->source, $this->offset, $this->length), $needle);
+
+        return ($index === false) ? -1 : $index;
+    }
+
+    /**
+     * Return true if the view is empty.
+     *
+     * @return bool
+     */
+    public function isEmpty(): bool {
+        return ($this->length === 0);
+    }
+
+    /**
+     * Return the amount of bytes in the view.
+     *
+     * @return int
+     */
+    public function length(): int {
+        return $this->length;
+    }
+
+    /**
+     * Return a generator that yields a view for each line. Lines are split on "\n" and a trailing "\r" is removed.
+     * A trailing newline does not yield an empty last line, and an empty view yields no lines.
+     *
+     * @return Iterator<\Titon\Type\StringView>
+     */
+    public function lines(): Iterator<StringView> {
+        $source = $this->source;
+        $end = $this->offset + $this->length;
+
+        foreach ($this->tokens("\n") as $line) {
+            $length = $line->length;
+
+            // The empty line after a trailing newline
+            if ($length === 0 && $line->offset === $end) {
+                break;
+            }
+
+            if ($length > 0 && $source[$line->offset + $length - 1] === "\r") {
+                $line->length--;
+            }
+
+            yield $line;
+        }
+    }
+
+    /**
+     * Checks to see if the view starts with a specific value.
+     *
+     * @param string $value
+     * @return bool
+     */
+    public function startsWith(string $value): bool {
+        $size = strlen($value);
+
+        if ($size === 0) {
+            return true;
+        }
+
+        return ($size <= $this->length && substr_compare($this->source, $value, $this->offset, $size) === 0);
+    }
+
+    /**
+     * Copy the range into a new StringBuffer.
+     *
+     * @return \Titon\Type\StringBuffer
+     */
+    public function toBuffer(): StringBuffer {
+        return new StringBuffer($this->toString());
+    }
+
+    /**
+     * Copy the range into a string.
+     *
+     * @return string
+     */
+    public function toString(): string {
+        if ($this->offset === 0 && $this->length === strlen($this->source)) {
+            return $this->source;
+        }
+
+        return (string) substr($this->source, $this->offset, $this->length);
+    }
+
+    /**
+     * Return a generator that yields a view for each token between delimiters. Tokens match the values
+     * `explode()` would return, but each token is only located once it is requested.
+     *
+     * @param string $delimiter
+     * @return Iterator<\Titon\Type\StringView>
+     * @throws \InvalidArgumentException
+     */
+    public function tokens(string $delimiter): Iterator<StringView> {
+        if ($delimiter === '') {
+            throw new \InvalidArgumentException('Token delimiter can not be empty');
+        }
+
+        $source = $this->source;
+        $haystack = $source;
+        $shift = 0;
+        $size = strlen($delimiter);
+        $end = $this->offset + $this->length;
+
+        // Search a copy of the view if it ends before the source, so that searches can not scan past the end of the view.
+        // Offsets are kept relative to the haystack and shifted back when creating views.
+        if ($end < strlen($source)) {
+            $haystack = (string) substr($source, $this->offset, $this->length);
+            $shift = $this->offset;
+        }
+
+        $offset = $this->offset - $shift;
+        $end -= $shift;
+
+        while (($index = strpos($haystack, $delimiter, $offset)) !== false) {
+            yield new static($source, $offset + $shift, $index - $offset);
+
+            $offset = $index + $size;
+        }
+
+        yield new static($source, $offset + $shift, $end - $offset);
+    }
+
+    /**
+     * Return a view with whitespace, or the defined characters, removed from both ends.
+     *
+     * @param string $chars
+     * @return \Titon\Type\StringView
+     */
+    public function trim(string $chars = " \t\n\r\0\x0B"): StringView {
+        $source = $this->source;
+        $start = $this->offset;
+        $end = $start + $this->length;
+
+        if ($start < $end) {
+            $start += strspn($source, $chars, $start, $end - $start);
+        }
+
+        while ($end > $start && strpos($chars, $source[$end - 1]) !== false) {
+            $end--;
+        }
+
+        return new static($source, $start, $end - $start);
+    }
+
+    /**
+     * Return a view over a range of this view. The range is clamped to the bounds of this view.
+     *
+     * @param int $offset
+     * @param int $length
+     * @return \Titon\Type\StringView
+     */
+    public function view(int $offset, ?int $length = null): StringView {
+        $offset = min(max($offset, 0), $this->length);
+        $remaining = $this->length - $offset;
+
+        return new static($this->source, $this->offset + $offset, ($length === null) ? $remaining : min(max($length, 0), $remaining));
+    }
+
+}
@@ -0,0 +1,104 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type;
+
+/**
+ * The UniqueList is an extension of the ArrayList that deduplicates values as they are inserted,
+ * while preserving the order in which values were first seen. Since values are hashable,
+ * membership checks use the value index and cost O(1), so repeated `unique()` passes are not needed.
+ *
+ * @package Titon\Type
+ */
+class UniqueList<Tv as arraykey> extends ArrayList<Tv> {
+
+    /**
+     * Membership checks always use the value index.
+     *
+     * @var bool
+     */
+    protected bool $valueIndexed = true;
+
+    /**
+     * Deduplicate the results of chained Vector methods, which modify the vector directly.
+     *
+     * @param string $method
+     * @param array<mixed> $args
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    public function __call(string $method, array<mixed> $args): ArrayList<Tv> {
+        $list = parent::__call($method, $args);
+
+        if ($list === $this) {
+            $this->adopt($this->value);
+            $this->invalidate();
+        }
+
+        return $list;
+    }
+
+    /**
+     * Add a value to the end of the list, unless it already exists.
+     *
+     * @param Tv $value
+     * @return $this
+     */
+    public function add(Tv $value): this {
+        if (!$this->contains($value)) {
+            parent::add($value);
+        }
+
+        return $this;
+    }
+
+    /**
+     * Overwrite the value at the specified index. If the value already exists at another index,
+     * the list is left unchanged.
+     *
+     * @param int $index
+     * @param Tv $value
+     * @return $this
+     */
+    public function set(int $index, Tv $value): this {
+        $existing = $this->keyOf($value);
+
+        if ($existing === -1 || $existing === $index) {
+            parent::set($index, $value);
+        }
+
+        return $this;
+    }
+
+    /**
+     * The values are already unique, so return a copy of the list.
+     *
+     * @param int $flags
+     * @param bool $strict
+     * @return \Titon\Type\ArrayList<Tv>
+     */
+    public function unique(int $flags = SORT_REGULAR, bool $strict = false): ArrayList<Tv> {
+        return clone $this;
+    }
+
+    /**
+     * Use the vector as the internal value, removing any duplicate values first.
+     * Every list that is written, unserialized, or derived from this list passes through here.
+     *
+     * @param Vector<Tv> $value
+     * @return $this
+     */
+    protected function adopt(Vector<Tv> $value): this {
+        $set = new Set($value);
+
+        if ($set->count() !== $value->count()) {
+            $value = $set->toVector();
+        }
+
+        return parent::adopt($value);
+    }
+
+}
@@ -8,10 +8,13 @@
 namespace Titon\Type;
 
 use Titon\Common\Exception\MissingFileException;
+use Titon\Type\Exception\InvalidXmlException;
+use Titon\Type\Exception\StreamException;
+use Titon\Type\Xml\Builder;
 use Titon\Type\Xml\Element;
 use Titon\Type\Xml\XmlMap;
 use Titon\Utility\Col;
-use \SimpleXMLElement;
+use \XMLReader;
 
 /**
  * The Xml class provides helper methods for XML parsing and building as well as static methods
@@ -21,6 +24,28 @@ use \SimpleXMLElement;
  */
 class Xml {
 
+    /**
+     * Amount of bytes to read or write at once during asynchronous I/O.
+     *
+     * @var int
+     */
+    public static int $chunkSize = 65536;
+
+    /**
+     * Maximum amount of formatted names to cache.
+     *
+     * @var int
+     */
+    public static int $nameCacheLimit = 10000;
+
+    /**
+     * Formatted names indexed by the original name. Since every element with the same name
+     * receives the cached string, names are also shared between elements.
+     *
+     * @var Map<string, string>
+     */
+    protected static Map<string, string> $names = Map {};
+
     /**
      * Box a value by type casting it from a string to a scalar.
      *
@@ -66,18 +91,30 @@ class Xml {
     /**
      * Format an element or attribute name for converting to camel case.
      * If the element starts with a number, prefix it with an underscore.
+     * Results are memoized, as the same names are formatted repeatedly while building a tree.
      *
+     * @param string $name
      * @return string
      */
     public static function formatName(string $name): string {
-        $name = preg_replace('/[^a-z0-9:\.\-_]+/i', '', $name);
-        $firstChar = mb_substr($name, 0, 1);
+        $names = static::$names;
+
+        if ($names->contains($name)) {
+            return $names[$name];
+        }
+
+        if ($names->count() >= static::$nameCacheLimit) {
+            $names->clear();
+        }
+
+        $formatted = preg_replace('/[^a-z0-9:\.\-_]+/i', '', $name);
+        $firstChar = mb_substr($formatted, 0, 1);
 
         if (is_numeric($firstChar) || $firstChar === '-' || $firstChar === '.') {
-            $name = '_' . $name;
+            $formatted = '_' . $formatted;
         }
 
-        return $name;
+        return $names[$name] = $formatted;
     }
 
     /**
@@ -103,17 +140,64 @@ class Xml {
 
     /**
      * Load an XML file from the file system and transform it into an Element tree.
+     * The file is read incrementally instead of being loaded into memory first.
+     * A builder can be passed to customize whitespace handling and name interning.
      *
      * @param string $path
+     * @param \Titon\Type\Xml\Builder $builder
      * @return \Titon\Type\Xml\Element
      * @throws \Titon\Common\Exception\MissingFileException
+     * @throws \Titon\Type\Exception\InvalidXmlException
      */
-    public static function fromFile(string $path): Element {
-        if (file_exists($path)) {
-            return static::fromString(file_get_contents($path));
+    public static function fromFile(string $path, ?Builder $builder = null): Element {
+        return ($builder ?: new Builder())->parseFile($path);
+    }
+
+    /**
+     * Asynchronously load an XML file from the file system and transform it into an Element tree.
+     * The file is read in chunks, yielding to other awaitables between chunks, so that many files
+     * can be loaded concurrently. Since XMLReader can not be fed incrementally, the document is parsed
+     * once it has been read.
+     *
+     * @param string $path
+     * @param \Titon\Type\Xml\Builder $builder
+     * @return Awaitable<\Titon\Type\Xml\Element>
+     * @throws \Titon\Common\Exception\MissingFileException
+     * @throws \Titon\Type\Exception\StreamException
+     * @throws \Titon\Type\Exception\InvalidXmlException
+     */
+    public static async function fromFileAsync(string $path, ?Builder $builder = null): Awaitable<Element> {
+        if (!file_exists($path)) {
+            throw new MissingFileException(sprintf('File %s does not exist', $path));
+        }
+
+        $handle = fopen($path, 'rb');
+
+        if (!$handle) {
+            throw new StreamException(sprintf('File %s could not be opened for reading', $path));
+        }
+
+        stream_set_blocking($handle, false);
+
+        $chunks = Vector {};
+
+        try {
+            while (!feof($handle)) {
+                await stream_await($handle, STREAM_AWAIT_READ, 0.0);
+
+                $chunk = fread($handle, static::$chunkSize);
+
+                if ($chunk === false) {
+                    throw new StreamException(sprintf('File %s could not be read', $path));
+                }
+
+                $chunks[] = $chunk;
+            }
+        } finally {
+            fclose($handle);
         }
 
-        throw new MissingFileException(sprintf('File %s does not exist', $path));
+        return ($builder ?: new Builder())->parseString(implode('', $chunks));
     }
 
     /**
@@ -137,12 +221,54 @@ class Xml {
 
     /**
      * Transform a string representation of an XML document into an Element tree.
+     * A builder can be passed to customize whitespace handling and name interning.
      *
      * @param string $string
+     * @param \Titon\Type\Xml\Builder $builder
      * @return \Titon\Type\Xml\Element
+     * @throws \Titon\Type\Exception\InvalidXmlException
      */
-    public static function fromString(string $string): Element {
-        return static::convertSimpleXml(simplexml_load_string($string));
+    public static function fromString(string $string, ?Builder $builder = null): Element {
+        return ($builder ?: new Builder())->parseString($string);
+    }
+
+    /**
+     * Asynchronously download an XML document and transform it into an Element tree.
+     * The request is made with non-blocking cURL, so that many documents can be downloaded concurrently.
+     *
+     * @param string $url
+     * @param \Titon\Type\Xml\Builder $builder
+     * @param int $timeout
+     * @return Awaitable<\Titon\Type\Xml\Element>
+     * @throws \Titon\Type\Exception\StreamException
+     * @throws \Titon\Type\Exception\InvalidXmlException
+     */
+    public static async function fromUrlAsync(string $url, ?Builder $builder = null, int $timeout = 30): Awaitable<Element> {
+        $curl = curl_init($url);
+
+        curl_setopt_array($curl, [
+            CURLOPT_RETURNTRANSFER => true,
+            CURLOPT_FOLLOWLOCATION => true,
+            CURLOPT_TIMEOUT => $timeout
+        ]);
+
+        try {
+            $body = await \HH\Asio\curl_exec($curl);
+
+            if (curl_errno($curl)) {
+                throw new StreamException(sprintf('URL %s could not be loaded: %s', $url, curl_error($curl)));
+            }
+
+            $status = (int) curl_getinfo($curl, CURLINFO_HTTP_CODE);
+
+            if ($status >= 400) {
+                throw new StreamException(sprintf('URL %s responded with status %s', $url, $status));
+            }
+        } finally {
+            curl_close($curl);
+        }
+
+        return ($builder ?: new Builder())->parseString($body);
     }
 
     /**
@@ -161,6 +287,27 @@ class Xml {
         return $root;
     }
 
+    /**
+     * Stream an XML file from the file system and yield an Element tree for every element that matches
+     * the defined name (a repeating element like `item`). Only a single matched element is held in memory
+     * at once, so memory usage stays flat regardless of the file size.
+     *
+     * @param string $path
+     * @param string $name
+     * @param \Titon\Type\Xml\Builder $builder
+     * @return Iterator<\Titon\Type\Xml\Element>
+     * @throws \Titon\Common\Exception\MissingFileException
+     * @throws \Titon\Type\Exception\InvalidXmlException
+     */
+    public static function stream(string $path, string $name, ?Builder $builder = null): Iterator<Element> {
+        if (!file_exists($path)) {
+            throw new MissingFileException(sprintf('File %s does not exist', $path));
+        }
+
+        // Share a builder so names are interned across all yielded trees
+        return static::readElements($path, $name, $builder ?: new Builder());
+    }
+
     /**
      * Add attributes to an element if the special `@attributes` map exists.
      *
@@ -225,37 +372,50 @@ class Xml {
     }
 
     /**
-     * Converts a SimpleXmlElement tree into an Element tree.
+     * Return a generator that reads the file and yields an Element tree for every element that matches the name.
+     * Parse errors are collected internally and thrown as exceptions, instead of being emitted as warnings.
+     * The reader is closed once the generator is finished or destroyed, even if iteration stops early.
      *
-     * @param \SimpleXMLElement $xml
-     * @return \Titon\Type\Xml\Element
+     * @param string $path
+     * @param string $name
+     * @param \Titon\Type\Xml\Builder $builder
+     * @return Iterator<\Titon\Type\Xml\Element>
+     * @throws \Titon\Type\Exception\InvalidXmlException
      */
-    protected static function convertSimpleXml(SimpleXMLElement $xml): Element {
-        $element = new Element($xml->getName());
+    protected static function readElements(string $path, string $name, Builder $builder): Iterator<Element> {
+        $errors = libxml_use_internal_errors(true);
+        $reader = new XMLReader();
+
+        libxml_clear_errors();
 
-        // Set attributes
-        if ($attributes = $xml->attributes()) {
-            foreach ($attributes as $key => $value) {
-                $element->setAttribute((string) $key, (string) $value);
+        try {
+            if (!$reader->open($path)) {
+                throw new InvalidXmlException(sprintf('Failed to open XML file %s', $path));
             }
-        }
 
-        // Set namespaces
-        if ($namespaces = $xml->getNamespaces()) {
-            foreach ($namespaces as $key => $value) {
-                $element->setNamespace((string) $key, (string) $value);
+            $found = $reader->read();
+
+            while ($found) {
+
+                // The builder leaves the reader on the end of the subtree
+                if ($reader->nodeType === XMLReader::ELEMENT && $reader->name === $name) {
+                    yield $builder->build($reader);
+                }
+
+                $found = $reader->read();
             }
-        }
 
-        // Set value
-        $element->setValue(trim((string) $xml));
+            $error = libxml_get_last_error();
 
-        // Add children
-        foreach ($xml->children() as $child) {
-            $element->addChild( static::convertSimpleXml($child) );
-        }
+            if ($error) {
+                throw new InvalidXmlException(sprintf('Failed to parse XML: %s on line %s', trim($error->message), $error->line));
+            }
+        } finally {
+            $reader->close();
 
-        return $element;
+            libxml_clear_errors();
+            libxml_use_internal_errors($errors);
+        }
     }
 
 }
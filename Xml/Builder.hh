@@ -0,0 +1,275 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Xml;
+
+use Titon\Common\Exception\MissingFileException;
+use Titon\Type\Exception\InvalidXmlException;
+use \XMLReader;
+
+/**
+ * The Builder reads an XML document node by node with XMLReader and builds the Element tree directly,
+ * in a single pass and without an intermediate document tree.
+ *
+ * Whitespace only text nodes can be skipped, and repeated element and attribute names can be interned,
+ * so that every element with the same name shares a single string instead of allocating its own.
+ *
+ * @package Titon\Type\Xml
+ */
+class Builder {
+
+    /**
+     * Maximum amount of names to intern per builder. Once reached, the interned names are cleared,
+     * so that a builder reused across many documents with unique names does not grow without bound.
+     *
+     * @var int
+     */
+    public static int $internLimit = 10000;
+
+    /**
+     * Whether to intern element and attribute names.
+     *
+     * @var bool
+     */
+    protected bool $internNames;
+
+    /**
+     * Interned names, shared for the lifetime of the builder until the intern limit is reached.
+     *
+     * @var Map<string, string>
+     */
+    protected Map<string, string> $names = Map {};
+
+    /**
+     * Whether to skip whitespace only text nodes and trim values.
+     *
+     * @var bool
+     */
+    protected bool $skipWhitespace;
+
+    /**
+     * Set the parsing options.
+     *
+     * @param bool $skipWhitespace
+     * @param bool $internNames
+     */
+    public function __construct(bool $skipWhitespace = true, bool $internNames = true) {
+        $this->skipWhitespace = $skipWhitespace;
+        $this->internNames = $internNames;
+    }
+
+    /**
+     * Build an Element tree from the current position of the reader. If the reader is positioned on an element,
+     * only that element and its descendants are read, and the reader is left on the end of the element.
+     * Otherwise the reader is advanced to the next element.
+     *
+     * @param \XMLReader $reader
+     * @return \Titon\Type\Xml\Element
+     * @throws \Titon\Type\Exception\InvalidXmlException
+     */
+    public function build(XMLReader $reader): Element {
+        $errors = libxml_use_internal_errors(true);
+
+        try {
+            return $this->read($reader);
+
+        } finally {
+            libxml_clear_errors();
+            libxml_use_internal_errors($errors);
+        }
+    }
+
+    /**
+     * Return the interned names.
+     *
+     * @return Map<string, string>
+     */
+    public function getNames(): Map<string, string> {
+        return $this->names;
+    }
+
+    /**
+     * Build an Element tree from an XML file, reading it from the file system incrementally.
+     *
+     * @param string $path
+     * @return \Titon\Type\Xml\Element
+     * @throws \Titon\Common\Exception\MissingFileException
+     * @throws \Titon\Type\Exception\InvalidXmlException
+     */
+    public function parseFile(string $path): Element {
+        if (!file_exists($path)) {
+            throw new MissingFileException(sprintf('File %s does not exist', $path));
+        }
+
+        $reader = new XMLReader();
+        $reader->open($path);
+
+        try {
+            return $this->build($reader);
+
+        } finally {
+            $reader->close();
+        }
+    }
+
+    /**
+     * Build an Element tree from a string representation of an XML document.
+     *
+     * @param string $string
+     * @return \Titon\Type\Xml\Element
+     * @throws \Titon\Type\Exception\InvalidXmlException
+     */
+    public function parseString(string $string): Element {
+        $reader = new XMLReader();
+        $reader->XML($string);
+
+        try {
+            return $this->build($reader);
+
+        } finally {
+            $reader->close();
+        }
+    }
+
+    /**
+     * Create an element from the reader's current element node, including its attributes and namespaces.
+     *
+     * @param \XMLReader $reader
+     * @return \Titon\Type\Xml\Element
+     */
+    protected function createElement(XMLReader $reader): Element {
+        $element = new Element($this->intern($reader->name));
+
+        if ($reader->hasAttributes) {
+            while ($reader->moveToNextAttribute()) {
+                $name = $reader->name;
+
+                // Prefixed namespace declarations, the default namespace is kept as an attribute
+                if ($reader->prefix === 'xmlns') {
+                    $element->setNamespace($this->intern($reader->localName), $reader->value);
+                } else {
+                    $element->setAttribute($this->intern($name), $reader->value);
+                }
+            }
+
+            $reader->moveToElement();
+        }
+
+        return $element;
+    }
+
+    /**
+     * Set the collected text as the value of the element.
+     *
+     * @param \Titon\Type\Xml\Element $element
+     * @param string $value
+     */
+    protected function finalize(Element $element, string $value): void {
+        if ($this->skipWhitespace) {
+            $value = trim($value);
+        }
+
+        if ($value !== '') {
+            $element->setValue($value);
+        }
+    }
+
+    /**
+     * Return a shared copy of the name if names are being interned.
+     *
+     * @param string $name
+     * @return string
+     */
+    protected function intern(string $name): string {
+        if (!$this->internNames) {
+            return $name;
+        }
+
+        $names = $this->names;
+
+        if ($names->contains($name)) {
+            return $names[$name];
+        }
+
+        if ($names->count() >= static::$internLimit) {
+            $names->clear();
+        }
+
+        return $names[$name] = $name;
+    }
+
+    /**
+     * Read nodes until the first element encountered has been closed. The elements that are still open
+     * are tracked on a stack, along with the text that has been collected for each of them.
+     *
+     * @param \XMLReader $reader
+     * @return \Titon\Type\Xml\Element
+     * @throws \Titon\Type\Exception\InvalidXmlException
+     */
+    protected function read(XMLReader $reader): Element {
+        $stack = Vector {};
+        $texts = Vector {};
+        $skipWhitespace = $this->skipWhitespace;
+        $found = ($reader->nodeType === XMLReader::ELEMENT) ?: $reader->read();
+
+        while ($found) {
+            switch ($reader->nodeType) {
+                case XMLReader::ELEMENT:
+                    $empty = $reader->isEmptyElement;
+                    $element = $this->createElement($reader);
+
+                    if (!$stack->isEmpty()) {
+                        $stack[$stack->count() - 1]->addChild($element);
+
+                    } else if ($empty) {
+                        return $element;
+                    }
+
+                    if (!$empty) {
+                        $stack[] = $element;
+                        $texts[] = '';
+                    }
+                break;
+
+                case XMLReader::END_ELEMENT:
+                    $element = $stack->pop();
+
+                    $this->finalize($element, $texts->pop());
+
+                    if ($stack->isEmpty()) {
+                        return $element;
+                    }
+                break;
+
+                case XMLReader::TEXT:
+                case XMLReader::CDATA:
+                    if (!$stack->isEmpty()) {
+                        $texts[$texts->count() - 1] .= $reader->value;
+                    }
+                break;
+
+                case XMLReader::WHITESPACE:
+                case XMLReader::SIGNIFICANT_WHITESPACE:
+                    if (!$skipWhitespace && !$stack->isEmpty()) {
+                        $texts[$texts->count() - 1] .= $reader->value;
+                    }
+                break;
+            }
+
+            $found = $reader->read();
+        }
+
+        $error = libxml_get_last_error();
+
+        if ($error) {
+            throw new InvalidXmlException(sprintf('Failed to parse XML: %s on line %s', trim($error->message), $error->line));
+        }
+
+        throw new InvalidXmlException($stack->isEmpty() ? 'No root element found in XML document' : 'Unexpected end of XML document');
+    }
+
+}
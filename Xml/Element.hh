@@ -7,6 +7,13 @@
 
 namespace Titon\Type\Xml;
 
+use Titon\Type\Binary;
+use Titon\Type\Exception\InvalidBinaryException;
+use Titon\Type\Exception\StreamException;
+use Titon\Type\Profiler;
+use Titon\Type\Sink;
+use Titon\Type\Sink\BufferSink;
+use Titon\Type\Sink\ChunkSink;
 use Titon\Type\Xml;
 use Titon\Utility\Sanitize;
 use \IteratorAggregate;
@@ -21,28 +28,64 @@ use \Countable;
 class Element implements IteratorAggregate<Element>, Countable {
 
     /**
-     * Map of attributes for this element.
+     * Default document declaration, shared by all root elements that have not customized it.
      *
      * @var \Titon\Type\Xml\AttributeMap
      */
-    protected AttributeMap $attributes = Map {};
+    protected static AttributeMap $defaultDeclaration = Map {
+        'version' => '1.0',
+        'encoding' => 'UTF-8'
+    };
+
+    /**
+     * Cache of indentation strings, indexed by depth.
+     *
+     * @var Vector<string>
+     */
+    protected static Vector<string> $indents = Vector {''};
+
+    /**
+     * Map of attributes for this element. Allocated when first used.
+     *
+     * @var \Titon\Type\Xml\AttributeMap
+     */
+    protected ?AttributeMap $attributes = null;
+
+    /**
+     * Whether the boxed value has been cached.
+     *
+     * @var bool
+     */
+    protected bool $boxed = false;
 
     /**
-     * List of children within this element.
+     * The cached type casted value. Reset when the value changes.
+     *
+     * @var mixed
+     */
+    protected mixed $boxedValue = null;
+
+    /**
+     * Lazily built mapping of child names to the children with that name.
+     *
+     * @var Map<string, \Titon\Type\Xml\ElementList>
+     */
+    protected ?Map<string, ElementList> $childIndex = null;
+
+    /**
+     * List of children within this element. Allocated when first used.
      *
      * @var \Titon\Type\Xml\ElementList
      */
-    protected ElementList $children = Vector {};
+    protected ?ElementList $children = null;
 
     /**
      * Map of attributes for document declaration (opening XML tag).
+     * Only allocated when the declaration is accessed, otherwise the default declaration is used.
      *
      * @var \Titon\Type\Xml\AttributeMap
      */
-    protected AttributeMap $declaration = Map {
-        'version' => '1.0',
-        'encoding' => 'UTF-8'
-    };
+    protected ?AttributeMap $declaration = null;
 
     /**
      * Name of this element.
@@ -52,11 +95,18 @@ class Element implements IteratorAggregate<Element>, Countable {
     protected string $name = '';
 
     /**
-     * Map of namespaces for this element.
+     * Lazily built mapping of namespace prefixes to the children within that namespace.
+     *
+     * @var Map<string, \Titon\Type\Xml\ElementList>
+     */
+    protected ?Map<string, ElementList> $namespaceIndex = null;
+
+    /**
+     * Map of namespaces for this element. Allocated when first used.
      *
      * @var \Titon\Type\Xml\NamespaceMap
      */
-    protected NamespaceMap $namespaces = Map {};
+    protected ?NamespaceMap $namespaces = null;
 
     /**
      * The parent element this child belongs to.
@@ -72,6 +122,13 @@ class Element implements IteratorAggregate<Element>, Countable {
      */
     protected string $value = '';
 
+    /**
+     * The cached value without the wrapping CDATA block. Reset when the value changes.
+     *
+     * @var string
+     */
+    protected ?string $valueWithoutCdata = null;
+
     /**
      * Create a new element and optionally set attributes.
      *
@@ -102,7 +159,19 @@ class Element implements IteratorAggregate<Element>, Countable {
     public function addChild(Element $child): this {
         $child->setParent($this);
 
-        $this->children[] = $child;
+        $children = $this->getChildren();
+        $children[] = $child;
+
+        // Update the indexes in place if they have been built
+        $name = $child->getName();
+
+        if ($this->childIndex !== null) {
+            static::appendIndex($this->childIndex, $name, $child);
+        }
+
+        if ($this->namespaceIndex !== null && ($pos = strpos($name, ':')) !== false) {
+            static::appendIndex($this->namespaceIndex, substr($name, 0, $pos), $child);
+        }
 
         return $this;
     }
@@ -127,7 +196,9 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return int
      */
     public function count(): int {
-        return count($this->children);
+        $children = $this->children;
+
+        return ($children === null) ? 0 : $children->count();
     }
 
     /**
@@ -140,7 +211,7 @@ class Element implements IteratorAggregate<Element>, Countable {
         $xml = '';
 
         foreach ($attributes as $key => $value) {
-            $xml .= sprintf(' %s="%s"', Xml::formatName($key), Sanitize::escape($value));
+            $xml .= ' ' . Xml::formatName($key) . '="' . Sanitize::escape($value) . '"';
         }
 
         return $xml;
@@ -156,12 +227,31 @@ class Element implements IteratorAggregate<Element>, Countable {
         $xml = '';
 
         foreach ($namespaces as $key => $value) {
-            $xml .= sprintf(' xmlns:%s="%s"', $key, Sanitize::escape($value));
+            $xml .= ' xmlns:' . $key . '="' . Sanitize::escape($value) . '"';
         }
 
         return $xml;
     }
 
+    /**
+     * Decode an element tree from the compact binary format created by `toBinary()`.
+     *
+     * @uses Titon\Type\Binary
+     *
+     * @param string $data
+     * @return \Titon\Type\Xml\Element
+     * @throws \Titon\Type\Exception\InvalidBinaryException
+     */
+    public static function fromBinary(string $data): Element {
+        $element = Binary::decode($data);
+
+        if ($element instanceof Element) {
+            return $element;
+        }
+
+        throw new InvalidBinaryException('Binary data does not contain an element');
+    }
+
     /**
      * Return an attributes value or an empty string if not found.
      *
@@ -169,7 +259,9 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return string
      */
     public function getAttribute(string $key): string {
-        return $this->getAttributes()->get($key) ?: '';
+        $attributes = $this->attributes;
+
+        return ($attributes === null) ? '' : ($attributes->get($key) ?: '');
     }
 
     /**
@@ -178,16 +270,27 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return \Titon\Type\Xml\AttributeMap
      */
     public function getAttributes(): AttributeMap {
-        return $this->attributes;
+        $attributes = $this->attributes;
+
+        if ($attributes === null) {
+            $attributes = $this->attributes = Map {};
+        }
+
+        return $attributes;
     }
 
     /**
-     * Return a type casted value.
+     * Return a type casted value. The value is only casted once until it changes.
      *
      * @return mixed
      */
     public function getBoxedValue(): mixed {
-        return Xml::box($this->getValueWithoutCdata());
+        if (!$this->boxed) {
+            $this->boxedValue = Xml::box($this->getValueWithoutCdata());
+            $this->boxed = true;
+        }
+
+        return $this->boxedValue;
     }
 
     /**
@@ -197,13 +300,13 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return \Titon\Type\Xml\Element
      */
     public function getChild(string $name): ?Element {
-        foreach ($this->getChildren() as $child) {
-            if ($child->getName() === $name) {
-                return $child;
-            }
+        $children = $this->childIndex()->get($name);
+
+        if ($children === null) {
+            return null;
         }
 
-        return null;
+        return $children[0];
     }
 
     /**
@@ -212,16 +315,23 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return \Titon\Type\Xml\ElementList
      */
     public function getChildren(): ElementList {
-        return $this->children;
+        $children = $this->children;
+
+        if ($children === null) {
+            $children = $this->children = Vector {};
+        }
+
+        return $children;
     }
 
     /**
      * Return a list of children with the defined name.
+     * The list is shared with the child index and should not be modified.
      *
      * @return \Titon\Type\Xml\ElementList
      */
     public function getChildrenByName(string $name): ElementList {
-        return $this->getChildren()->filter( $item ==> $item->getName() === $name );
+        return $this->childIndex()->get($name) ?: Vector {};
     }
 
     /**
@@ -230,7 +340,13 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return \Titon\Type\Xml\AttributeMap
      */
     public function getDeclaration(): AttributeMap {
-        return $this->declaration;
+        $declaration = $this->declaration;
+
+        if ($declaration === null) {
+            $declaration = $this->declaration = static::$defaultDeclaration->toMap();
+        }
+
+        return $declaration;
     }
 
     /**
@@ -239,7 +355,7 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return Iterator<Element>
      */
     public function getIterator(): Iterator<Element> {
-        return $this->getChildren()->getIterator();
+        return ($this->children ?: Vector {})->getIterator();
     }
 
     /**
@@ -258,7 +374,9 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return string
      */
     public function getNamespace(string $key): string {
-        return $this->getNamespaces()->get($key) ?: '';
+        $namespaces = $this->namespaces;
+
+        return ($namespaces === null) ? '' : ($namespaces->get($key) ?: '');
     }
 
     /**
@@ -267,7 +385,13 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return \Titon\Type\Xml\NamespaceMap
      */
     public function getNamespaces(): NamespaceMap {
-        return $this->namespaces;
+        $namespaces = $this->namespaces;
+
+        if ($namespaces === null) {
+            $namespaces = $this->namespaces = Map {};
+        }
+
+        return $namespaces;
     }
 
     /**
@@ -277,17 +401,18 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return \Titon\Type\Xml\AttributeMap
      */
     public function getNamespaceAttributes(string $namespace): AttributeMap {
-        return $this->getAttributes()->filterWithKey( ($key, $value) ==> strpos($key, $namespace . ':') === 0 );
+        return ($this->attributes ?: Map {})->filterWithKey( ($key, $value) ==> strpos($key, $namespace . ':') === 0 );
     }
 
     /**
      * Return all children for a specific namespace.
+     * The list is shared with the namespace index and should not be modified.
      *
      * @param string $namespace
      * @return \Titon\Type\Xml\ElementList
      */
     public function getNamespaceChildren(string $namespace): ElementList {
-        return $this->getChildren()->filter( $item ==> strpos($item->getName(), $namespace . ':') === 0 );
+        return $this->namespaceIndex()->get($namespace) ?: Vector {};
     }
 
     /**
@@ -309,11 +434,17 @@ class Element implements IteratorAggregate<Element>, Countable {
     }
 
     /**
-     * Return the value without the wrapping CDATA block.
+     * Return the value without the wrapping CDATA block. The block is only removed once until the value changes.
      *
      * @return string
      */
     public function getValueWithoutCdata(): string {
+        $cached = $this->valueWithoutCdata;
+
+        if ($cached !== null) {
+            return $cached;
+        }
+
         $value = $this->getValue();
 
         if (strpos($value, '<![CDATA[') === 0) {
@@ -322,6 +453,8 @@ class Element implements IteratorAggregate<Element>, Countable {
             $value = trim($value); // Remove newlines
         }
 
+        $this->valueWithoutCdata = $value;
+
         return $value;
     }
 
@@ -332,7 +465,9 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return bool
      */
     public function hasAttribute(string $key): bool {
-        return $this->getAttributes()->contains($key);
+        $attributes = $this->attributes;
+
+        return ($attributes !== null && $attributes->contains($key));
     }
 
     /**
@@ -341,7 +476,9 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return bool
      */
     public function hasAttributes(): bool {
-        return !$this->getAttributes()->isEmpty();
+        $attributes = $this->attributes;
+
+        return ($attributes !== null && !$attributes->isEmpty());
     }
 
     /**
@@ -350,7 +487,9 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return bool
      */
     public function hasChildren(): bool {
-        return !$this->getChildren()->isEmpty();
+        $children = $this->children;
+
+        return ($children !== null && !$children->isEmpty());
     }
 
     /**
@@ -360,7 +499,9 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return bool
      */
     public function hasNamespace(string $key): bool {
-        return $this->getNamespaces()->contains($key);
+        $namespaces = $this->namespaces;
+
+        return ($namespaces !== null && $namespaces->contains($key));
     }
 
     /**
@@ -369,7 +510,9 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return bool
      */
     public function hasNamespaces(): bool {
-        return !$this->getNamespaces()->isEmpty();
+        $namespaces = $this->namespaces;
+
+        return ($namespaces !== null && !$namespaces->isEmpty());
     }
 
     /**
@@ -381,6 +524,15 @@ class Element implements IteratorAggregate<Element>, Countable {
         return !$this->isRoot();
     }
 
+    /**
+     * Return true if the children have been indexed by name.
+     *
+     * @return bool
+     */
+    public function isIndexed(): bool {
+        return ($this->childIndex !== null);
+    }
+
     /**
      * Return true if the element is the top level parent node.
      *
@@ -390,6 +542,20 @@ class Element implements IteratorAggregate<Element>, Countable {
         return ($this->getParent() === null);
     }
 
+    /**
+     * Return all elements that match an XPath-like query, relative to this element.
+     * Queries are compiled once and cached, see the Query class for the supported syntax.
+     *
+     * @uses Titon\Type\Xml\Query
+     *
+     * @param string $path
+     * @return \Titon\Type\Xml\ElementList
+     * @throws \Titon\Type\Exception\InvalidQueryException
+     */
+    public function query(string $path): ElementList {
+        return Query::compile($path)->find($this);
+    }
+
     /**
      * Set an attributes value. The value will be type casted and unboxed into a string.
      *
@@ -403,7 +569,8 @@ class Element implements IteratorAggregate<Element>, Countable {
             $key = $namespace . ':' . $key;
         }
 
-        $this->attributes[$key] = Xml::unbox($value);
+        $attributes = $this->getAttributes();
+        $attributes[$key] = Xml::unbox($value);
 
         return $this;
     }
@@ -434,7 +601,7 @@ class Element implements IteratorAggregate<Element>, Countable {
         $attributes['version'] = $version;
         $attributes['encoding'] = $encoding;
 
-        $this->declaration->setAll($attributes);
+        $this->getDeclaration()->setAll($attributes);
 
         return $this;
     }
@@ -456,6 +623,11 @@ class Element implements IteratorAggregate<Element>, Countable {
 
         $this->name = $name;
 
+        // The parent's indexes are keyed by the old name
+        if ($this->parent !== null) {
+            $this->parent->invalidate();
+        }
+
         return $this;
     }
 
@@ -467,7 +639,8 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return $this
      */
     public function setNamespace(string $key, string $value): this {
-        $this->namespaces[$key] = $value;
+        $namespaces = $this->getNamespaces();
+        $namespaces[$key] = $value;
 
         return $this;
     }
@@ -514,9 +687,39 @@ class Element implements IteratorAggregate<Element>, Countable {
 
         $this->value = $value;
 
+        // Reset the cached values
+        $this->valueWithoutCdata = null;
+        $this->boxedValue = null;
+        $this->boxed = false;
+
         return $this;
     }
 
+    /**
+     * Return the element and its descendants encoded in a compact binary format,
+     * so that parsed documents can be cached without being parsed again.
+     *
+     * @uses Titon\Type\Binary
+     *
+     * @return string
+     */
+    public function toBinary(): string {
+        return Binary::encode($this);
+    }
+
+    /**
+     * Return a lazy view of the element as the nested map structure `toMap()` would return,
+     * which only converts the parts of the tree that are accessed.
+     *
+     * @uses Titon\Type\Xml\LazyMap
+     *
+     * @param bool $includeRoot
+     * @return \Titon\Type\Xml\LazyMap
+     */
+    public function toLazyMap(bool $includeRoot = true): LazyMap {
+        return new LazyMap($this, $includeRoot && $this->isRoot());
+    }
+
     /**
      * Return the element as a nested map structure.
      *
@@ -524,6 +727,10 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return \Titon\Type\XmlMap
      */
     public function toMap(bool $includeRoot = true): XmlMap {
+        if (Profiler::$enabled) {
+            Profiler::record(static::class, __FUNCTION__, 1);
+        }
+
         $map = Map {};
 
         if ($this->hasAttributes()) {
@@ -574,49 +781,287 @@ class Element implements IteratorAggregate<Element>, Countable {
      * @return string
      */
     public function toString(bool $indent = true, int $depth = 0): string {
-        $xml = '';
+        $start = Profiler::$enabled ? microtime(true) : 0.0;
+        $sink = new BufferSink();
+
+        $this->writeTo($sink, $indent, $depth);
+
+        $string = $sink->toString();
+
+        if ($start > 0.0) {
+            Profiler::record(static::class, __FUNCTION__, 0, strlen($string), 0, $start);
+        }
+
+        return $string;
+    }
+
+    /**
+     * Write the element as XML to a sink in a single depth-first pass, without building
+     * intermediate strings for each child.
+     *
+     * @param \Titon\Type\Sink $sink
+     * @param bool $indent
+     * @param int $depth
+     * @return $this
+     */
+    public function writeTo(Sink $sink, bool $indent = true, int $depth = 0): this {
 
         // Set root XML tag
         if ($this->isRoot()) {
-            $xml = sprintf('<?xml%s?>', $this->formatAttributes($this->getDeclaration())) . PHP_EOL;
+            $sink->write('<?xml' . $this->formatAttributes($this->declaration ?: static::$defaultDeclaration) . '?>' . PHP_EOL);
         }
 
-        // Apply indenting for nested elements
-        if ($indent) {
-            $xml .= str_repeat('    ', $depth);
+        $this->writeElement($sink, $indent, $depth);
+
+        $sink->flush();
+
+        return $this;
+    }
+
+    /**
+     * Asynchronously write the element as an XML document to a file, and return the amount of bytes written.
+     * The document is serialized in chunks, and each chunk is written once the file is writable,
+     * so that the whole document is never held in memory and many documents can be written concurrently.
+     *
+     * @param string $path
+     * @param bool $indent
+     * @return Awaitable<int>
+     * @throws \Titon\Type\Exception\StreamException
+     */
+    public async function writeToFileAsync(string $path, bool $indent = true): Awaitable<int> {
+        $handle = fopen($path, 'wb');
+
+        if (!$handle) {
+            throw new StreamException(sprintf('File %s could not be opened for writing', $path));
         }
 
-        // Build the tag, its attributes and namespaces
-        $xml .= sprintf('<%s%s%s',
-            $this->getName(),
-            $this->formatNamespaces($this->getNamespaces()),
-            $this->formatAttributes($this->getAttributes())
-        );
+        stream_set_blocking($handle, false);
 
-        // No children or value so self close
-        if (!$this->hasChildren() && $this->getValue() === '') {
-            return $xml . '/>' . PHP_EOL;
+        $sink = new ChunkSink(Xml::$chunkSize);
+        $bytes = 0;
+
+        try {
+            if ($this->isRoot()) {
+                $sink->write('<?xml' . $this->formatAttributes($this->declaration ?: static::$defaultDeclaration) . '?>' . PHP_EOL);
+            }
+
+            // Serialization pauses whenever chunks are ready, so they can be written before continuing
+            foreach ($this->writeChunks($sink, $indent, 0) as $chunks) {
+                $bytes += await static::writeStream($handle, $chunks, $path);
+            }
+
+            $sink->flush();
+
+            $bytes += await static::writeStream($handle, $sink->drain(), $path);
+        } finally {
+            fclose($handle);
+        }
+
+        return $bytes;
+    }
+
+    /**
+     * Append a child to the list of children under the key in an index.
+     *
+     * @param Map<string, \Titon\Type\Xml\ElementList> $index
+     * @param string $key
+     * @param \Titon\Type\Xml\Element $child
+     */
+    protected static function appendIndex(Map<string, ElementList> $index, string $key, Element $child): void {
+        if ($index->contains($key)) {
+            $index[$key][] = $child;
         } else {
-            $xml .= '>';
+            $index[$key] = Vector {$child};
         }
+    }
 
-        // Children take precedence over a value
+    /**
+     * Return the indentation for the defined depth.
+     *
+     * @param int $depth
+     * @return string
+     */
+    protected static function indentation(int $depth): string {
+        $indents = static::$indents;
+
+        while ($indents->count() <= $depth) {
+            $indents[] = $indents[$indents->count() - 1] . '    ';
+        }
+
+        return $indents[$depth];
+    }
+
+    /**
+     * Return the child name index, building it if it does not exist.
+     *
+     * @return Map<string, \Titon\Type\Xml\ElementList>
+     */
+    protected function childIndex(): Map<string, ElementList> {
+        $index = $this->childIndex;
+
+        if ($index === null) {
+            $index = Map {};
+
+            foreach ($this->children ?: Vector {} as $child) {
+                static::appendIndex($index, $child->getName(), $child);
+            }
+
+            $this->childIndex = $index;
+        }
+
+        return $index;
+    }
+
+    /**
+     * Reset the lazily built child indexes.
+     */
+    protected function invalidate(): void {
+        $this->childIndex = null;
+        $this->namespaceIndex = null;
+    }
+
+    /**
+     * Return the namespace prefix index, building it if it does not exist.
+     *
+     * @return Map<string, \Titon\Type\Xml\ElementList>
+     */
+    protected function namespaceIndex(): Map<string, ElementList> {
+        $index = $this->namespaceIndex;
+
+        if ($index === null) {
+            $index = Map {};
+
+            foreach ($this->children ?: Vector {} as $child) {
+                $name = $child->getName();
+
+                if (($pos = strpos($name, ':')) !== false) {
+                    static::appendIndex($index, substr($name, 0, $pos), $child);
+                }
+            }
+
+            $this->namespaceIndex = $index;
+        }
+
+        return $index;
+    }
+
+    /**
+     * Return the opening tag of the element, with its attributes and namespaces, but without the closing bracket.
+     *
+     * @param string $pad
+     * @return string
+     */
+    protected function openTag(string $pad): string {
+        $attributes = $this->attributes;
+        $namespaces = $this->namespaces;
+
+        return $pad . '<' . $this->getName() .
+            ($namespaces ? $this->formatNamespaces($namespaces) : '') .
+            ($attributes ? $this->formatAttributes($attributes) : '');
+    }
+
+    /**
+     * Write the element to the sink the same as `writeElement()`, but yield the queued chunks whenever
+     * writing a child completes a chunk, so that the chunks can be written out before serialization continues.
+     *
+     * @param \Titon\Type\Sink\ChunkSink $sink
+     * @param bool $indent
+     * @param int $depth
+     * @return Iterator<Vector<string>>
+     */
+    protected function writeChunks(ChunkSink $sink, bool $indent, int $depth): Iterator<Vector<string>> {
         if ($this->hasChildren()) {
-            $xml .= PHP_EOL;
+            $pad = $indent ? static::indentation($depth) : '';
+
+            $sink->write($this->openTag($pad) . '>' . PHP_EOL);
 
             foreach ($this->getChildren() as $child) {
-                $xml .= $child->toString($indent, $depth + 1);
+                foreach ($child->writeChunks($sink, $indent, $depth + 1) as $chunks) {
+                    yield $chunks;
+                }
             }
 
-            // Apply indenting for nested elements
-            if ($indent) {
-                $xml .= str_repeat('    ', $depth);
+            $sink->write($pad . '</' . $this->getName() . '>' . PHP_EOL);
+
+        } else {
+            $this->writeElement($sink, $indent, $depth);
+        }
+
+        if ($sink->hasChunks()) {
+            yield $sink->drain();
+        }
+    }
+
+    /**
+     * Write the element, its attributes and namespaces, and its children or value to the sink.
+     *
+     * @param \Titon\Type\Sink $sink
+     * @param bool $indent
+     * @param int $depth
+     */
+    protected function writeElement(Sink $sink, bool $indent, int $depth): void {
+        $name = $this->getName();
+        $pad = $indent ? static::indentation($depth) : '';
+
+        $sink->write($this->openTag($pad));
+
+        // Children take precedence over a value
+        if ($this->hasChildren()) {
+            $sink->write('>' . PHP_EOL);
+
+            foreach ($this->getChildren() as $child) {
+                $child->writeElement($sink, $indent, $depth + 1);
             }
+
+            $sink->write($pad . '</' . $name . '>' . PHP_EOL);
+
+        // No children or value so self close
+        } else if ($this->getValue() === '') {
+            $sink->write('/>' . PHP_EOL);
+
         } else {
-            $xml .= $this->getValue();
+            $sink->write('>' . $this->getValue() . '</' . $name . '>' . PHP_EOL);
+        }
+    }
+
+    /**
+     * Asynchronously write chunks to a non-blocking stream, waiting until the stream is writable before each write.
+     * Partial and empty writes are retried once the stream is writable again. Return the amount of bytes written.
+     *
+     * @param resource $handle
+     * @param Vector<string> $chunks
+     * @param string $path
+     * @return Awaitable<int>
+     * @throws \Titon\Type\Exception\StreamException
+     */
+    protected static async function writeStream(resource $handle, Vector<string> $chunks, string $path): Awaitable<int> {
+        $bytes = 0;
+
+        foreach ($chunks as $chunk) {
+            $length = strlen($chunk);
+            $offset = 0;
+
+            while ($offset < $length) {
+                $status = await stream_await($handle, STREAM_AWAIT_WRITE, 0.0);
+
+                if ($status === STREAM_AWAIT_ERROR || $status === STREAM_AWAIT_CLOSED) {
+                    throw new StreamException(sprintf('File %s could not be written', $path));
+                }
+
+                // A non-blocking write may accept only part of the chunk, or nothing at all
+                $written = fwrite($handle, ($offset === 0) ? $chunk : substr($chunk, $offset));
+
+                if ($written === false) {
+                    throw new StreamException(sprintf('File %s could not be written', $path));
+                }
+
+                $offset += $written;
+            }
+
+            $bytes += $length;
         }
 
-        return $xml . sprintf('</%s>', $this->getName()) . PHP_EOL;
+        return $bytes;
     }
 
 }
@@ -0,0 +1,274 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Xml;
+
+use Titon\Common\Mapable;
+use \ArrayAccess;
+use \Countable;
+use \IteratorAggregate;
+use \LogicException;
+use \OutOfBoundsException;
+
+/**
+ * The LazyMap is a read-only view of an Element as the map structure `Element::toMap()` would return.
+ * Instead of converting the whole tree upfront, each key is converted when it is first accessed, and children
+ * are returned as lazy maps of their own. Converting a document therefore costs only as much as the fields read.
+ *
+ * Converted values are cached, so the element should not be modified while the view is in use.
+ * Use `toMap()` to convert the view into the same nested maps and vectors as `Element::toMap()`.
+ *
+ * @package Titon\Type\Xml
+ */
+class LazyMap implements
+    ArrayAccess<string, mixed>,
+    IteratorAggregate<mixed>,
+    Countable,
+    Mapable<string, mixed> {
+
+    /**
+     * The element being viewed.
+     *
+     * @var \Titon\Type\Xml\Element
+     */
+    protected Element $element;
+
+    /**
+     * Keys in the order `Element::toMap()` would define them. Built when first used.
+     *
+     * @var Vector<string>
+     */
+    protected ?Vector<string> $keys = null;
+
+    /**
+     * Whether the element is wrapped by a map of its name, like a root element that includes itself.
+     *
+     * @var bool
+     */
+    protected bool $wrapped;
+
+    /**
+     * Values that have been converted, mapped by key.
+     *
+     * @var \Titon\Type\Xml\XmlMap
+     */
+    protected XmlMap $values = Map {};
+
+    /**
+     * Set the element to view, and whether the element should be wrapped by a map of its name.
+     *
+     * @param \Titon\Type\Xml\Element $element
+     * @param bool $wrapped
+     */
+    final public function __construct(Element $element, bool $wrapped = false) {
+        $this->element = $element;
+        $this->wrapped = $wrapped;
+    }
+
+    /**
+     * Return the value for the key or throw an exception if it does not exist.
+     *
+     * @param string $key
+     * @return mixed
+     * @throws \OutOfBoundsException
+     */
+    public function at(string $key): mixed {
+        if (!$this->contains($key)) {
+            throw new OutOfBoundsException(sprintf('Key %s does not exist', $key));
+        }
+
+        return $this->get($key);
+    }
+
+    /**
+     * Return true if the key exists.
+     *
+     * @param string $key
+     * @return bool
+     */
+    public function contains(string $key): bool {
+        return $this->keys()->linearSearch($key) >= 0;
+    }
+
+    /**
+     * Return the number of keys.
+     *
+     * @return int
+     */
+    public function count(): int {
+        return $this->keys()->count();
+    }
+
+    /**
+     * Return the value for the key, converting it if it has not been accessed yet, or null if it does not exist.
+     * Children are returned as lazy maps, and children that share a name as a vector of lazy maps.
+     *
+     * @param string $key
+     * @return mixed
+     */
+    public function get(string $key): mixed {
+        $values = $this->values;
+
+        if ($values->contains($key)) {
+            return $values[$key];
+        }
+
+        $value = $this->convert($key);
+        $values[$key] = $value;
+
+        return $value;
+    }
+
+    /**
+     * Return the element being viewed.
+     *
+     * @return \Titon\Type\Xml\Element
+     */
+    public function getElement(): Element {
+        return $this->element;
+    }
+
+    /**
+     * Return a generator that converts each value as it is reached.
+     *
+     * @return KeyedIterator<string, mixed>
+     */
+    public function getIterator(): KeyedIterator<string, mixed> {
+        foreach ($this->keys() as $key) {
+            yield $key => $this->get($key);
+        }
+    }
+
+    /**
+     * Return the keys without converting any values.
+     *
+     * @return Vector<string>
+     */
+    public function keys(): Vector<string> {
+        $keys = $this->keys;
+
+        if ($keys !== null) {
+            return $keys;
+        }
+
+        $element = $this->element;
+        $keys = Vector {};
+
+        if ($this->wrapped) {
+            $keys[] = $element->getName();
+
+        } else {
+            if ($element->hasAttributes()) {
+                $keys[] = '@attributes';
+            }
+
+            if ($element->hasChildren()) {
+                $names = Set {};
+
+                foreach ($element->getChildren() as $child) {
+                    $name = $child->getName();
+
+                    if (!$names->contains($name)) {
+                        $names[] = $name;
+                        $keys[] = $name;
+                    }
+                }
+
+            } else {
+                $keys[] = '@value';
+            }
+        }
+
+        $this->keys = $keys;
+
+        return $keys;
+    }
+
+    /**
+     * Alias for `contains()`.
+     *
+     * @param string $key
+     * @return bool
+     */
+    public function offsetExists(string $key): bool {
+        return $this->contains($key);
+    }
+
+    /**
+     * Alias for `get()`.
+     *
+     * @param string $key
+     * @return mixed
+     */
+    public function offsetGet(string $key): mixed {
+        return $this->get($key);
+    }
+
+    /**
+     * The view is read-only.
+     *
+     * @param string $key
+     * @param mixed $value
+     * @throws \LogicException
+     */
+    public function offsetSet(string $key, mixed $value): void {
+        throw new LogicException('LazyMap is read-only');
+    }
+
+    /**
+     * The view is read-only.
+     *
+     * @param string $key
+     * @throws \LogicException
+     */
+    public function offsetUnset(string $key): void {
+        throw new LogicException('LazyMap is read-only');
+    }
+
+    /**
+     * Convert the whole view into nested maps and vectors, the same as `Element::toMap()`.
+     *
+     * @return \Titon\Type\Xml\XmlMap
+     */
+    public function toMap(): XmlMap {
+        return $this->element->toMap($this->wrapped);
+    }
+
+    /**
+     * Convert the value for a key.
+     *
+     * @param string $key
+     * @return mixed
+     */
+    protected function convert(string $key): mixed {
+        $element = $this->element;
+
+        if ($this->wrapped) {
+            return ($key === $element->getName()) ? new static($element) : null;
+        }
+
+        if ($key === '@attributes') {
+            return $element->hasAttributes() ? $element->getAttributes() : null;
+
+        } else if ($key === '@value' && !$element->hasChildren()) {
+            return $element->getBoxedValue();
+        }
+
+        $children = $element->getChildrenByName($key);
+
+        switch ($children->count()) {
+            case 0:
+                return null;
+
+            case 1:
+                return new static($children[0]);
+        }
+
+        return $children->map($child ==> new static($child));
+    }
+
+}
@@ -0,0 +1,145 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Xml;
+
+use Titon\Type\Xml;
+use \Exception;
+
+/**
+ * The Loader asynchronously loads many XML documents from files and URLs, with a limit on how many
+ * documents are loaded at once. Sources that start with `http://` or `https://` are downloaded,
+ * while all other sources are read from the file system.
+ *
+ * A source that fails to load does not stop the other sources from loading.
+ * Its exception is available from `getErrors()` instead.
+ *
+ * @package Titon\Type\Xml
+ */
+class Loader {
+
+    /**
+     * The builder shared by all documents, so that names are interned across documents.
+     *
+     * @var \Titon\Type\Xml\Builder
+     */
+    protected Builder $builder;
+
+    /**
+     * Maximum amount of documents to load at once.
+     *
+     * @var int
+     */
+    protected int $concurrency;
+
+    /**
+     * Exceptions from the last load, mapped by source.
+     *
+     * @var Map<string, \Exception>
+     */
+    protected Map<string, Exception> $errors = Map {};
+
+    /**
+     * Set the concurrency limit and an optional builder.
+     *
+     * @param int $concurrency
+     * @param \Titon\Type\Xml\Builder $builder
+     */
+    public function __construct(int $concurrency = 8, ?Builder $builder = null) {
+        $this->concurrency = max($concurrency, 1);
+        $this->builder = $builder ?: new Builder();
+    }
+
+    /**
+     * Return the concurrency limit.
+     *
+     * @return int
+     */
+    public function getConcurrency(): int {
+        return $this->concurrency;
+    }
+
+    /**
+     * Return the exceptions from the last load, mapped by source.
+     *
+     * @return Map<string, \Exception>
+     */
+    public function getErrors(): Map<string, Exception> {
+        return $this->errors;
+    }
+
+    /**
+     * Load a single document from a file or URL.
+     *
+     * @param string $source
+     * @return Awaitable<\Titon\Type\Xml\Element>
+     */
+    public async function load(string $source): Awaitable<Element> {
+        if (preg_match('/^https?:\/\//i', $source)) {
+            return await Xml::fromUrlAsync($source, $this->builder);
+        }
+
+        return await Xml::fromFileAsync($source, $this->builder);
+    }
+
+    /**
+     * Load all documents, with at most the concurrency limit loading at once.
+     * Return the loaded documents mapped by source, in the order the sources were defined.
+     *
+     * @param Traversable<string> $sources
+     * @return Awaitable<Map<string, \Titon\Type\Xml\Element>>
+     */
+    public async function loadAll(Traversable<string> $sources): Awaitable<Map<string, Element>> {
+        $sources = new Vector($sources);
+        $loaded = Map {};
+        $this->errors = Map {};
+
+        // Workers pull from the end of the queue, so reverse it to load in order
+        $queue = $sources->toVector();
+        $queue->reverse();
+
+        $workers = Vector {};
+
+        for ($i = min($this->concurrency, $queue->count()); $i > 0; $i--) {
+            $workers[] = $this->work($queue, $loaded);
+        }
+
+        await \HH\Asio\v($workers);
+
+        // Workers finish in any order
+        $documents = Map {};
+
+        foreach ($sources as $source) {
+            if ($loaded->contains($source)) {
+                $documents[$source] = $loaded[$source];
+            }
+        }
+
+        return $documents;
+    }
+
+    /**
+     * Load documents from the queue until it is empty.
+     *
+     * @param Vector<string> $queue
+     * @param Map<string, \Titon\Type\Xml\Element> $loaded
+     * @return Awaitable<void>
+     */
+    protected async function work(Vector<string> $queue, Map<string, Element> $loaded): Awaitable<void> {
+        while (!$queue->isEmpty()) {
+            $source = $queue->pop();
+
+            try {
+                $loaded[$source] = await $this->load($source);
+
+            } catch (Exception $e) {
+                $this->errors[$source] = $e;
+            }
+        }
+    }
+
+}
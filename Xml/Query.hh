@@ -0,0 +1,578 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Xml;
+
+use Titon\Type\Exception\InvalidQueryException;
+
+/**
+ * The Query class compiles an XPath-like path into a list of steps that can be evaluated against
+ * an Element tree in a single depth-first traversal. Compiled queries are cached by path.
+ *
+ * The following syntax is supported:
+ *
+ *  - `item/price` - Children named `price` of children named `item`
+ *  - `/catalog/item` - Absolute path, starting from the root element of the tree
+ *  - `catalog//price` - Descendants named `price` at any depth
+ *  - `item/*` - Children with any name
+ *  - `item[@type]` - Elements with a `type` attribute
+ *  - `item[@type=book]` - Elements with a `type` attribute equal to `book` (values may be quoted)
+ *  - `item[sku]` - Elements with a `sku` child
+ *  - `item[sku=123]` - Elements with a `sku` child whose value equals `123`
+ *  - `item[2]` - The second matching element within its parent (1-based)
+ *
+ * Each element is returned once, even when descendant steps reach it through multiple matched ancestors,
+ * and elements are returned in document order. When a descendant step is followed by other steps, it can match
+ * an element and one of its descendants, so the later steps reach elements out of order. Those queries collect
+ * every match and sort them by document order before the limit is applied, so `first()` no longer stops early.
+ *
+ * @package Titon\Type\Xml
+ */
+class Query {
+
+    const int ATTRIBUTE = 1;
+    const int ATTRIBUTE_EQUALS = 2;
+    const int CHILD = 3;
+    const int CHILD_EQUALS = 4;
+    const int POSITION = 5;
+
+    /**
+     * Maximum amount of compiled queries to cache.
+     *
+     * @var int
+     */
+    public static int $cacheLimit = 500;
+
+    /**
+     * Compiled queries indexed by path.
+     *
+     * @var Map<string, \Titon\Type\Xml\Query>
+     */
+    protected static Map<string, Query> $cache = Map {};
+
+    /**
+     * Whether the first step is matched against the root of the tree.
+     *
+     * @var bool
+     */
+    protected bool $absolute = false;
+
+    /**
+     * The original path.
+     *
+     * @var string
+     */
+    protected string $path;
+
+    /**
+     * The compiled steps.
+     *
+     * @var Vector<\Titon\Type\Xml\QueryStep>
+     */
+    protected Vector<QueryStep> $steps = Vector {};
+
+    /**
+     * Compile the path.
+     *
+     * @param string $path
+     * @throws \Titon\Type\Exception\InvalidQueryException
+     */
+    public function __construct(string $path) {
+        $this->path = $path;
+        $this->parse(trim($path));
+    }
+
+    /**
+     * Return a compiled query for the path, either from the cache or by compiling it.
+     *
+     * @param string $path
+     * @return \Titon\Type\Xml\Query
+     */
+    public static function compile(string $path): Query {
+        $cache = static::$cache;
+
+        if ($cache->contains($path)) {
+            return $cache[$path];
+        }
+
+        if ($cache->count() >= static::$cacheLimit) {
+            $cache->clear();
+        }
+
+        return $cache[$path] = new static($path);
+    }
+
+    /**
+     * Return all elements that match the query, starting from the context element.
+     *
+     * @param \Titon\Type\Xml\Element $context
+     * @return \Titon\Type\Xml\ElementList
+     */
+    public function find(Element $context): ElementList {
+        $results = Vector {};
+
+        $this->run($context, $results, 0);
+
+        return $results;
+    }
+
+    /**
+     * Return the first element that matches the query, or null if nothing matches.
+     * The traversal stops as soon as a match is found, unless the query must sort its matches by document order.
+     *
+     * @param \Titon\Type\Xml\Element $context
+     * @return \Titon\Type\Xml\Element
+     */
+    public function first(Element $context): ?Element {
+        $results = Vector {};
+
+        $this->run($context, $results, 1);
+
+        return $results->isEmpty() ? null : $results[0];
+    }
+
+    /**
+     * Return the original path.
+     *
+     * @return string
+     */
+    public function getPath(): string {
+        return $this->path;
+    }
+
+    /**
+     * Return the compiled steps.
+     *
+     * @return Vector<\Titon\Type\Xml\QueryStep>
+     */
+    public function getSteps(): Vector<QueryStep> {
+        return $this->steps;
+    }
+
+    /**
+     * Return the children of the context element that a named step should consider.
+     * The child index is only used if it has already been built, as building an index for every element
+     * visited by a query would permanently inflate the memory of the tree.
+     *
+     * @param \Titon\Type\Xml\Element $context
+     * @param string $name
+     * @return \Titon\Type\Xml\ElementList
+     */
+    protected function candidates(Element $context, string $name): ElementList {
+        if ($name !== '*' && $context->isIndexed()) {
+            return $context->getChildrenByName($name);
+        }
+
+        return $context->getChildren();
+    }
+
+    /**
+     * Evaluate a step against the children of the context element, or against all its descendants
+     * for a descendant step. Returns false once the limit has been reached.
+     *
+     * @param \Titon\Type\Xml\Element $context
+     * @param int $index
+     * @param \Titon\Type\Xml\ElementList $results
+     * @param int $limit
+     * @param Map<int, Set<string>> $visited
+     * @return bool
+     */
+    protected function evaluate(Element $context, int $index, ElementList $results, int $limit, Map<int, Set<string>> $visited): bool {
+        $step = $this->steps[$index];
+
+        // Descendant steps must walk every child, so only child steps can be narrowed by name
+        $candidates = $step['descendant'] ? $context->getChildren() : $this->candidates($context, $step['name']);
+
+        return $this->match($candidates, $step, $index, $results, $limit, $visited);
+    }
+
+    /**
+     * Filter a list of candidates by the step's name and predicates, and continue to the next step
+     * for each candidate that matches. For a descendant step, the children of each candidate are walked
+     * before its next sibling, so that the step matches elements in document order. Returns false once the limit has been reached.
+     *
+     * @param \Titon\Type\Xml\ElementList $candidates
+     * @param \Titon\Type\Xml\QueryStep $step
+     * @param int $index
+     * @param \Titon\Type\Xml\ElementList $results
+     * @param int $limit
+     * @param Map<int, Set<string>> $visited
+     * @return bool
+     */
+    protected function match(ElementList $candidates, QueryStep $step, int $index, ElementList $results, int $limit, Map<int, Set<string>> $visited): bool {
+        $name = $step['name'];
+        $predicates = $step['predicates'];
+        $descendant = $step['descendant'];
+        $positions = Vector {};
+
+        foreach ($predicates as $predicate) {
+            $positions[] = 0;
+        }
+
+        foreach ($candidates as $candidate) {
+            $matched = ($name === '*' || $candidate->getName() === $name);
+
+            if ($matched) {
+                foreach ($predicates as $i => $predicate) {
+                    if (!$this->test($candidate, $predicate, ++$positions[$i])) {
+                        $matched = false;
+                        break;
+                    }
+                }
+            }
+
+            if ($matched && !$this->visit($candidate, $index, $results, $limit, $visited)) {
+                return false;
+            }
+
+            if ($descendant && !$this->match($candidate->getChildren(), $step, $index, $results, $limit, $visited)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Append the elements below the context that are in the set of hashes to the results, in document order.
+     * Returns false once the limit has been reached, or once every hashed element has been found.
+     *
+     * @param \Titon\Type\Xml\Element $context
+     * @param Set<string> $hashes
+     * @param \Titon\Type\Xml\ElementList $results
+     * @param int $limit
+     * @return bool
+     */
+    protected function order(Element $context, Set<string> $hashes, ElementList $results, int $limit): bool {
+        foreach ($context->getChildren() as $child) {
+            if ($hashes->contains(spl_object_hash($child))) {
+                $results[] = $child;
+
+                if ($results->count() === $hashes->count() || ($limit > 0 && $results->count() >= $limit)) {
+                    return false;
+                }
+            }
+
+            if (!$this->order($child, $hashes, $results, $limit)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Parse the path into steps and predicates.
+     *
+     * @param string $path
+     * @throws \Titon\Type\Exception\InvalidQueryException
+     */
+    protected function parse(string $path): void {
+        $length = strlen($path);
+        $descendant = false;
+        $i = 0;
+
+        if (substr($path, 0, 2) === '//') {
+            $descendant = true;
+            $i = 2;
+
+        } else if (substr($path, 0, 1) === '/') {
+            $this->absolute = true;
+            $i = 1;
+        }
+
+        while ($i < $length) {
+            $name = '';
+            $predicates = Vector {};
+
+            // Step name
+            while ($i < $length && $path[$i] !== '/' && $path[$i] !== '[') {
+                $name .= $path[$i++];
+            }
+
+            $name = trim($name);
+
+            if ($name === '') {
+                throw new InvalidQueryException(sprintf('Missing element name at offset %s in query "%s"', $i, $path));
+            }
+
+            // Predicates
+            while ($i < $length && $path[$i] === '[') {
+                $end = $this->scan($path, $i + 1, ']');
+
+                if ($end === -1) {
+                    throw new InvalidQueryException(sprintf('Unclosed predicate at offset %s in query "%s"', $i, $path));
+                }
+
+                $predicates[] = $this->parsePredicate(trim(substr($path, $i + 1, $end - $i - 1)), $path);
+                $i = $end + 1;
+            }
+
+            $this->steps[] = shape(
+                'descendant' => $descendant,
+                'name' => $name,
+                'predicates' => $predicates
+            );
+
+            // Separator
+            $descendant = false;
+
+            if ($i < $length) {
+                if ($path[$i] !== '/') {
+                    throw new InvalidQueryException(sprintf('Unexpected character at offset %s in query "%s"', $i, $path));
+                }
+
+                if (($i + 1) < $length && $path[$i + 1] === '/') {
+                    $descendant = true;
+                    $i++;
+                }
+
+                $i++;
+
+                if ($i >= $length) {
+                    throw new InvalidQueryException(sprintf('Query "%s" can not end with a separator', $path));
+                }
+            }
+        }
+
+        if ($this->steps->isEmpty()) {
+            throw new InvalidQueryException('Query path can not be empty');
+        }
+    }
+
+    /**
+     * Parse the contents of a predicate.
+     *
+     * @param string $predicate
+     * @param string $path
+     * @return \Titon\Type\Xml\QueryPredicate
+     * @throws \Titon\Type\Exception\InvalidQueryException
+     */
+    protected function parsePredicate(string $predicate, string $path): QueryPredicate {
+        if ($predicate === '') {
+            throw new InvalidQueryException(sprintf('Empty predicate in query "%s"', $path));
+        }
+
+        if (ctype_digit($predicate)) {
+            return shape('type' => static::POSITION, 'key' => '', 'value' => $predicate);
+        }
+
+        $attribute = ($predicate[0] === '@');
+        $key = $attribute ? substr($predicate, 1) : $predicate;
+        $value = '';
+        $equals = strpos($key, '=');
+
+        if ($equals !== false) {
+            $value = trim(substr($key, $equals + 1));
+            $key = substr($key, 0, $equals);
+
+            // Remove wrapping quotes
+            if (strlen($value) >= 2 && ($value[0] === '"' || $value[0] === "'") && substr($value, -1) === $value[0]) {
+                $value = substr($value, 1, -1);
+            }
+        }
+
+        $key = trim($key);
+
+        if ($key === '') {
+            throw new InvalidQueryException(sprintf('Missing name in predicate "%s" in query "%s"', $predicate, $path));
+        }
+
+        if ($attribute) {
+            $type = ($equals !== false) ? static::ATTRIBUTE_EQUALS : static::ATTRIBUTE;
+        } else {
+            $type = ($equals !== false) ? static::CHILD_EQUALS : static::CHILD;
+        }
+
+        return shape('type' => $type, 'key' => $key, 'value' => $value);
+    }
+
+    /**
+     * Evaluate the query from the context element, appending matches to the results list.
+     *
+     * @param \Titon\Type\Xml\Element $context
+     * @param \Titon\Type\Xml\ElementList $results
+     * @param int $limit
+     */
+    protected function run(Element $context, ElementList $results, int $limit): void {
+        $visited = Map {};
+        $ordered = true;
+        $last = $this->steps->count() - 1;
+
+        foreach ($this->steps as $index => $step) {
+
+            // A descendant step after the first can reach the same element through multiple matched ancestors,
+            // so the elements matched by those steps are tracked. Every other step reaches an element only once.
+            if ($index > 0 && $step['descendant']) {
+                $visited[$index] = Set {};
+            }
+
+            // A descendant step followed by other steps can match nested elements,
+            // and the steps after it are evaluated from the outer element first
+            if ($index < $last && $step['descendant']) {
+                $ordered = false;
+            }
+        }
+
+        // Absolute paths match the first step against the root of the tree
+        if ($this->absolute) {
+            while (($parent = $context->getParent()) !== null) {
+                $context = $parent;
+            }
+        }
+
+        if ($ordered) {
+            $this->search($context, $results, $limit, $visited);
+
+            return;
+        }
+
+        $matches = Vector {};
+
+        $this->search($context, $matches, 0, $visited);
+
+        if ($matches->count() <= 1) {
+            $results->addAll($matches);
+
+            return;
+        }
+
+        $hashes = Set {};
+
+        foreach ($matches as $match) {
+            $hashes[] = spl_object_hash($match);
+        }
+
+        $this->order($context, $hashes, $results, $limit);
+    }
+
+    /**
+     * Return the offset of the closing character, skipping over quoted values, or -1 if not found.
+     *
+     * @param string $path
+     * @param int $offset
+     * @param string $char
+     * @return int
+     */
+    protected function scan(string $path, int $offset, string $char): int {
+        $quote = '';
+
+        for ($i = $offset, $length = strlen($path); $i < $length; $i++) {
+            $current = $path[$i];
+
+            if ($quote !== '') {
+                if ($current === $quote) {
+                    $quote = '';
+                }
+
+            } else if ($current === '"' || $current === "'") {
+                $quote = $current;
+
+            } else if ($current === $char) {
+                return $i;
+            }
+        }
+
+        return -1;
+    }
+
+    /**
+     * Evaluate the first step from the context element, or against the context itself for absolute paths.
+     * Returns false once the limit has been reached.
+     *
+     * @param \Titon\Type\Xml\Element $context
+     * @param \Titon\Type\Xml\ElementList $results
+     * @param int $limit
+     * @param Map<int, Set<string>> $visited
+     * @return bool
+     */
+    protected function search(Element $context, ElementList $results, int $limit, Map<int, Set<string>> $visited): bool {
+        if ($this->absolute) {
+            return $this->match(Vector {$context}, $this->steps[0], 0, $results, $limit, $visited);
+        }
+
+        return $this->evaluate($context, 0, $results, $limit, $visited);
+    }
+
+    /**
+     * Test a candidate against a predicate. The position is the candidate's 1-based position
+     * amongst the candidates that passed the previous predicates.
+     *
+     * @param \Titon\Type\Xml\Element $candidate
+     * @param \Titon\Type\Xml\QueryPredicate $predicate
+     * @param int $position
+     * @return bool
+     */
+    protected function test(Element $candidate, QueryPredicate $predicate, int $position): bool {
+        $key = $predicate['key'];
+
+        switch ($predicate['type']) {
+            case static::ATTRIBUTE:
+                return $candidate->hasAttribute($key);
+
+            case static::ATTRIBUTE_EQUALS:
+                return ($candidate->hasAttribute($key) && $candidate->getAttribute($key) === $predicate['value']);
+
+            case static::CHILD:
+                foreach ($this->candidates($candidate, $key) as $child) {
+                    if ($child->getName() === $key) {
+                        return true;
+                    }
+                }
+
+                return false;
+
+            case static::CHILD_EQUALS:
+                foreach ($this->candidates($candidate, $key) as $child) {
+                    if ($child->getName() === $key && $child->getValueWithoutCdata() === $predicate['value']) {
+                        return true;
+                    }
+                }
+
+                return false;
+
+            case static::POSITION:
+                return ($position === (int) $predicate['value']);
+        }
+
+        return false;
+    }
+
+    /**
+     * Continue to the next step from an element that matched a step, or add it to the results if the step is last.
+     * Elements that were already matched by the step are skipped. Returns false once the limit has been reached.
+     *
+     * @param \Titon\Type\Xml\Element $element
+     * @param int $index
+     * @param \Titon\Type\Xml\ElementList $results
+     * @param int $limit
+     * @param Map<int, Set<string>> $visited
+     * @return bool
+     */
+    protected function visit(Element $element, int $index, ElementList $results, int $limit, Map<int, Set<string>> $visited): bool {
+        $seen = $visited->get($index);
+
+        if ($seen !== null) {
+            $hash = spl_object_hash($element);
+
+            if ($seen->contains($hash)) {
+                return true;
+            }
+
+            $seen[] = $hash;
+        }
+
+        if ($index < $this->steps->count() - 1) {
+            return $this->evaluate($element, $index + 1, $results, $limit, $visited);
+        }
+
+        $results[] = $element;
+
+        return ($limit <= 0 || $results->count() < $limit);
+    }
+
+}
@@ -0,0 +1,321 @@
+<?hh // strict
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Xml;
+
+use Titon\Type\ArrayList;
+use Titon\Type\HashMap;
+use Titon\Type\Sink;
+use Titon\Type\Xml;
+use Titon\Utility\Sanitize;
+
+/**
+ * The Writer streams maps and vectors as XML directly to a sink, without building an Element tree first.
+ * It follows the same conventions as `Xml::fromMap()` and `Xml::fromVector()`, and produces the same output
+ * as converting the resulting tree to a string:
+ *
+ *  - A map is an element with children, one for each key.
+ *  - A map with a `@value` key is an element with a value, wrapped in a CDATA block if `@cdata` is true.
+ *  - A map with an `@attributes` map defines the attributes of the element. The map is not modified.
+ *  - A vector is a list of elements with the same name.
+ *  - A scalar is an element with a value.
+ *
+ * Formatted element and attribute names are cached for the lifetime of the writer.
+ *
+ * @package Titon\Type\Xml
+ */
+class Writer {
+
+    /**
+     * Whether to indent the output.
+     *
+     * @var bool
+     */
+    protected bool $indent;
+
+    /**
+     * Indentation strings for each depth.
+     *
+     * @var Vector<string>
+     */
+    protected Vector<string> $indents = Vector {''};
+
+    /**
+     * Formatted names indexed by the original name.
+     *
+     * @var Map<string, string>
+     */
+    protected Map<string, string> $names = Map {};
+
+    /**
+     * The sink to write output to.
+     *
+     * @var \Titon\Type\Sink
+     */
+    protected Sink $sink;
+
+    /**
+     * Set the sink and whether to indent.
+     *
+     * @param \Titon\Type\Sink $sink
+     * @param bool $indent
+     */
+    public function __construct(Sink $sink, bool $indent = true) {
+        $this->sink = $sink;
+        $this->indent = $indent;
+    }
+
+    /**
+     * Return the sink.
+     *
+     * @return \Titon\Type\Sink
+     */
+    public function getSink(): Sink {
+        return $this->sink;
+    }
+
+    /**
+     * Write a map as a document with the defined root element, and flush the sink.
+     *
+     * @param string $root
+     * @param \Titon\Type\Xml\XmlMap $map
+     * @return $this
+     */
+    public function writeMap(string $root, XmlMap $map): this {
+        $this->writeDeclaration();
+        $this->writeParent($this->name($root), $map, 0);
+
+        $this->sink->flush();
+
+        return $this;
+    }
+
+    /**
+     * Write a vector as a document with the defined root element, and an item element for each value,
+     * and flush the sink.
+     *
+     * @param string $root
+     * @param string $item
+     * @param Vector<Tv> $list
+     * @return $this
+     */
+    public function writeVector<Tv>(string $root, string $item, Vector<Tv> $list): this {
+        $name = $this->name($root);
+        $pad = $this->indentation(0);
+        $sink = $this->sink;
+
+        $this->writeDeclaration();
+
+        if ($this->hasElements($list)) {
+            $sink->write($pad . '<' . $name . '>' . PHP_EOL);
+
+            $this->writeNode($item, $list, 1);
+
+            $sink->write($pad . '</' . $name . '>' . PHP_EOL);
+
+        } else {
+            $sink->write($pad . '<' . $name . '/>' . PHP_EOL);
+        }
+
+        $sink->flush();
+
+        return $this;
+    }
+
+    /**
+     * Return the attributes of a map formatted for a tag.
+     *
+     * @param Map<string, mixed> $map
+     * @return string
+     */
+    protected function formatAttributes(Map<string, mixed> $map): string {
+        $attributes = $map->get('@attributes');
+        $xml = '';
+
+        if ($attributes instanceof Map) {
+            foreach ($attributes as $key => $value) {
+                $xml .= ' ' . $this->name((string) $key) . '="' . Sanitize::escape(Xml::unbox($value)) . '"';
+            }
+        }
+
+        return $xml;
+    }
+
+    /**
+     * Return true if writing the value under a parent element would produce at least one element.
+     * Only nested vectors can be empty, as every other value is written as an element.
+     *
+     * @param mixed $value
+     * @return bool
+     */
+    protected function hasElements(mixed $value): bool {
+        $value = $this->unwrap($value);
+
+        if ($value instanceof Vector) {
+            foreach ($value as $item) {
+                if ($this->hasElements($item)) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Return the indentation for the defined depth.
+     *
+     * @param int $depth
+     * @return string
+     */
+    protected function indentation(int $depth): string {
+        if (!$this->indent) {
+            return '';
+        }
+
+        $indents = $this->indents;
+
+        while ($indents->count() <= $depth) {
+            $indents[] = $indents[$indents->count() - 1] . '    ';
+        }
+
+        return $indents[$depth];
+    }
+
+    /**
+     * Return the formatted name for an element or attribute.
+     *
+     * @param string $name
+     * @return string
+     */
+    protected function name(string $name): string {
+        $names = $this->names;
+
+        if ($names->contains($name)) {
+            return $names[$name];
+        }
+
+        return $names[$name] = Xml::formatName($name);
+    }
+
+    /**
+     * Return the raw collection of an ArrayList or HashMap, or the value itself.
+     *
+     * @param mixed $value
+     * @return mixed
+     */
+    protected function unwrap(mixed $value): mixed {
+        if ($value instanceof ArrayList || $value instanceof HashMap) {
+            return $value->view();
+        }
+
+        return $value;
+    }
+
+    /**
+     * Write the XML declaration.
+     */
+    protected function writeDeclaration(): void {
+        $this->sink->write('<?xml version="1.0" encoding="UTF-8"?>' . PHP_EOL);
+    }
+
+    /**
+     * Write an element for a value under the key, mirroring `Xml::createElement()`.
+     *
+     * @param string $key
+     * @param mixed $value
+     * @param int $depth
+     */
+    protected function writeNode(string $key, mixed $value, int $depth): void {
+        // UNSAFE
+        // Nested maps are structurally typed as `Map<string, mixed>`
+        $value = $this->unwrap($value);
+
+        if ($value instanceof Map) {
+
+            // An element with a value
+            if ($value->contains('@value')) {
+                $text = Xml::unbox($value['@value']);
+
+                if ($value->get('@cdata')) {
+                    $text = '<![CDATA[' . PHP_EOL . $text . PHP_EOL . ']]>';
+                }
+
+                $this->writeValue($this->name($key), $this->formatAttributes($value), $text, $depth);
+
+            // Multiple elements as children
+            } else {
+                $this->writeParent($this->name($key), $value, $depth);
+            }
+
+        // Multiple elements with the same name
+        } else if ($value instanceof Vector) {
+            foreach ($value as $item) {
+                $this->writeNode($key, $item, $depth);
+            }
+
+        // An element with a value
+        } else {
+            $this->writeValue($this->name($key), '', Xml::unbox($value), $depth);
+        }
+    }
+
+    /**
+     * Write an element whose children are the pairs of a map, except for the attributes.
+     *
+     * @param string $name
+     * @param Map<string, mixed> $map
+     * @param int $depth
+     */
+    protected function writeParent(string $name, Map<string, mixed> $map, int $depth): void {
+        $sink = $this->sink;
+        $pad = $this->indentation($depth);
+        $open = $pad . '<' . $name . $this->formatAttributes($map);
+        $empty = true;
+
+        foreach ($map as $key => $value) {
+            if ($key === '@attributes' || !$this->hasElements($value)) {
+                continue;
+            }
+
+            // The tag is only closed once the first child is found, as elements without children self close
+            if ($empty) {
+                $sink->write($open . '>' . PHP_EOL);
+                $empty = false;
+            }
+
+            $this->writeNode((string) $key, $value, $depth + 1);
+        }
+
+        if ($empty) {
+            $sink->write($open . '/>' . PHP_EOL);
+        } else {
+            $sink->write($pad . '</' . $name . '>' . PHP_EOL);
+        }
+    }
+
+    /**
+     * Write an element with a value, which self closes if the value is empty.
+     *
+     * @param string $name
+     * @param string $attributes
+     * @param string $value
+     * @param int $depth
+     */
+    protected function writeValue(string $name, string $attributes, string $value, int $depth): void {
+        $pad = $this->indentation($depth);
+
+        if ($value === '') {
+            $this->sink->write($pad . '<' . $name . $attributes . '/>' . PHP_EOL);
+        } else {
+            $this->sink->write($pad . '<' . $name . $attributes . '>' . $value . '</' . $name . '>' . PHP_EOL);
+        }
+    }
+
+}
@@ -0,0 +1,138 @@
+<?hh
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Bench;
+
+use Titon\Type\ArrayList;
+use Titon\Type\HashMap;
+use Titon\Type\Xml;
+
+/**
+ * Benchmark cases for the ArrayList and HashMap hot paths.
+ *
+ * @package Titon\Type\Bench
+ */
+class CollectionCases {
+
+    /**
+     * Register all collection cases for every size.
+     *
+     * @param \Titon\Type\Bench\Suite $suite
+     * @param Vector<int> $sizes
+     */
+    public static function register(Suite $suite, Vector<int> $sizes): void {
+        foreach ($sizes as $size) {
+            static::registerArrayList($suite, $size);
+            static::registerHashMap($suite, $size);
+        }
+    }
+
+    /**
+     * Register the ArrayList cases.
+     *
+     * @param \Titon\Type\Bench\Suite $suite
+     * @param int $size
+     */
+    protected static function registerArrayList(Suite $suite, int $size): void {
+        $suite->add('ArrayList', 'concat', $size, () ==> {
+            $list = new ArrayList(Fixture::integers($size));
+
+            return () ==> $list->concat($list);
+        });
+
+        $suite->add('ArrayList', 'chunk', $size, () ==> {
+            $list = new ArrayList(Fixture::integers($size));
+
+            return () ==> $list->chunk(100);
+        });
+
+        $suite->add('ArrayList', 'unique', $size, () ==> {
+            $list = new ArrayList(Fixture::integers($size));
+
+            return () ==> $list->unique();
+        });
+
+        $suite->add('ArrayList', 'sort', $size, () ==> {
+            $list = new ArrayList(Fixture::integers($size));
+
+            return () ==> $list->sort();
+        });
+
+        // Compare a partial sort against taking the first items of a full sort
+        $suite->add('ArrayList', 'topK(20)', $size, () ==> {
+            $list = new ArrayList(Fixture::integers($size));
+
+            return () ==> $list->topK(20);
+        });
+
+        $suite->add('ArrayList', 'filter->map chain', $size, () ==> {
+            $list = new ArrayList(Fixture::integers($size));
+
+            return () ==> $list->filter($value ==> $value % 2 === 0)->map($value ==> $value * 2)->filter($value ==> $value > 10);
+        });
+
+        // Compare the cost of magic __call() dispatch against a directly defined method
+        $suite->add('ArrayList', '__call dispatch (reserve)', $size, () ==> {
+            $list = new ArrayList(Fixture::integers($size));
+
+            return () ==> $list->reserve(0);
+        });
+
+        $suite->add('ArrayList', 'direct method (set)', $size, () ==> {
+            $list = new ArrayList(Fixture::integers($size));
+
+            return () ==> $list->set(0, 1);
+        });
+    }
+
+    /**
+     * Register the HashMap cases.
+     *
+     * @param \Titon\Type\Bench\Suite $suite
+     * @param int $size
+     */
+    protected static function registerHashMap(Suite $suite, int $size): void {
+        $suite->add('HashMap', 'groupBy', $size, () ==> {
+            $map = new HashMap(Fixture::records($size));
+
+            return () ==> $map->groupBy($record ==> $record['status']);
+        });
+
+        $suite->add('HashMap', 'reorder', $size, () ==> {
+            $map = new HashMap(Fixture::records($size));
+
+            return () ==> $map->reorder($record ==> $record['id']);
+        });
+
+        // Hash join both sides on the record id, consuming the lazy result
+        $suite->add('HashMap', 'join (by id)', $size, () ==> {
+            $map = new HashMap(Fixture::records($size));
+
+            return () ==> $map->join($map, $record ==> (int) $record['id'], $record ==> (int) $record['id'])->count();
+        });
+
+        $suite->add('HashMap', 'indexOf (last key)', $size, () ==> {
+            $map = new HashMap(Fixture::records($size));
+            $key = 'record' . ($size - 1);
+
+            return () ==> $map->indexOf($key);
+        });
+
+        $suite->add('HashMap', 'Xml::fromMap->toString', $size, () ==> {
+            $records = Fixture::records($size);
+
+            return () ==> Xml::fromMap('document', $records)->toString();
+        });
+
+        $suite->add('HashMap', 'toXml', $size, () ==> {
+            $map = new HashMap(Fixture::records($size));
+
+            return () ==> $map->toXml();
+        });
+    }
+
+}
@@ -0,0 +1,83 @@
+<?hh
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Bench;
+
+/**
+ * The Fixture class generates reproducible data sets of a specific size for benchmark cases.
+ *
+ * @package Titon\Type\Bench
+ */
+class Fixture {
+
+    /**
+     * Return a list of random integers. The generator is seeded so every run uses the same data.
+     *
+     * @param int $size
+     * @return Vector<int>
+     */
+    public static function integers(int $size): Vector<int> {
+        mt_srand($size);
+
+        $list = Vector {};
+        $list->reserve($size);
+
+        for ($i = 0; $i < $size; $i++) {
+            $list[] = mt_rand(0, $size);
+        }
+
+        return $list;
+    }
+
+    /**
+     * Return a map of string keys to record maps.
+     *
+     * @param int $size
+     * @return Map<string, Map<string, mixed>>
+     */
+    public static function records(int $size): Map<string, Map<string, mixed>> {
+        mt_srand($size);
+
+        $map = Map {};
+        $map->reserve($size);
+
+        for ($i = 0; $i < $size; $i++) {
+            $map['record' . $i] = Map {
+                'id' => $i,
+                'status' => 'status' . mt_rand(0, 9),
+                'price' => mt_rand(100, 10000) / 100
+            };
+        }
+
+        return $map;
+    }
+
+    /**
+     * Return an XML document of approximately the defined amount of bytes.
+     *
+     * @param int $bytes
+     * @return string
+     */
+    public static function xml(int $bytes): string {
+        $xml = '<?xml version="1.0" encoding="UTF-8"?>' . PHP_EOL . '<catalog>' . PHP_EOL;
+        $i = 0;
+
+        while (strlen($xml) < $bytes) {
+            $xml .= sprintf('    <item id="%d" type="%s">' . PHP_EOL .
+                '        <name>Item %d</name>' . PHP_EOL .
+                '        <price>%.2f</price>' . PHP_EOL .
+                '        <sku>SKU-%08d</sku>' . PHP_EOL .
+                '    </item>' . PHP_EOL,
+                $i, ($i % 2) ? 'book' : 'movie', $i, $i / 10, $i);
+
+            $i++;
+        }
+
+        return $xml . '</catalog>' . PHP_EOL;
+    }
+
+}
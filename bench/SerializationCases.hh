@@ -0,0 +1,80 @@
+<?hh
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Bench;
+
+use Titon\Type\ArrayList;
+use Titon\Type\HashMap;
+use Titon\Type\Xml;
+use Titon\Type\Xml\Element;
+
+/**
+ * Benchmark cases that compare the binary format against `serialize()`. The bytes per operation
+ * of the encoding cases is the size of the encoded output, so the formats can be compared for size as well.
+ *
+ * @package Titon\Type\Bench
+ */
+class SerializationCases {
+
+    /**
+     * Register all serialization cases for every collection and document size.
+     *
+     * @param \Titon\Type\Bench\Suite $suite
+     * @param Vector<int> $sizes
+     * @param Vector<int> $documents
+     */
+    public static function register(Suite $suite, Vector<int> $sizes, Vector<int> $documents): void {
+        foreach ($sizes as $size) {
+            static::registerFormats($suite, 'ArrayList', $size, () ==> new ArrayList(Fixture::integers($size)));
+            static::registerFormats($suite, 'HashMap', $size, () ==> new HashMap(Fixture::records($size)));
+        }
+
+        foreach ($documents as $size) {
+            static::registerFormats($suite, 'Element', $size, () ==> Xml::fromString(Fixture::xml($size)));
+        }
+    }
+
+    /**
+     * Register the encode and decode cases for both formats.
+     *
+     * @param \Titon\Type\Bench\Suite $suite
+     * @param string $group
+     * @param int $size
+     * @param (function(): mixed) $fixture
+     */
+    protected static function registerFormats(Suite $suite, string $group, int $size, (function(): mixed) $fixture): void {
+        $suite->add($group, 'serialize', $size, () ==> {
+            $value = $fixture();
+
+            return () ==> serialize($value);
+        });
+
+        $suite->add($group, 'unserialize', $size, () ==> {
+            $data = serialize($fixture());
+
+            return () ==> unserialize($data);
+        });
+
+        $suite->add($group, 'toBinary', $size, () ==> {
+            $value = $fixture();
+
+            return () ==> $value->toBinary();
+        });
+
+        $suite->add($group, 'fromBinary', $size, () ==> {
+            $value = $fixture();
+            $data = $value->toBinary();
+
+            if ($value instanceof Element) {
+                return () ==> Element::fromBinary($data);
+            }
+
+            return () ==> $value::fromBinary($data);
+        });
+    }
+
+}
@@ -0,0 +1,78 @@
+<?hh
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Bench;
+
+use Titon\Type\StringBuffer;
+
+/**
+ * Benchmark cases for the StringBuffer hot paths.
+ *
+ * @package Titon\Type\Bench
+ */
+class StringCases {
+
+    /**
+     * Register all string cases for every size. The size is the amount of appended lines.
+     *
+     * @param \Titon\Type\Bench\Suite $suite
+     * @param Vector<int> $sizes
+     */
+    public static function register(Suite $suite, Vector<int> $sizes): void {
+        foreach ($sizes as $size) {
+            $suite->add('StringBuffer', 'append chain', $size, () ==> {
+                return () ==> {
+                    $buffer = new StringBuffer();
+
+                    for ($i = 0; $i < $size; $i++) {
+                        $buffer = $buffer->append('Line ' . $i . PHP_EOL);
+                    }
+
+                    return $buffer;
+                };
+            });
+
+            $suite->add('StringBuffer', 'builder append', $size, () ==> {
+                return () ==> {
+                    $builder = (new StringBuffer())->builder($size);
+
+                    for ($i = 0; $i < $size; $i++) {
+                        $builder->append('Line ' . $i . PHP_EOL);
+                    }
+
+                    return $builder->toString();
+                };
+            });
+
+            $suite->add('StringBuffer', 'replace 500 needles', $size, () ==> {
+                $needles = Vector {};
+
+                for ($i = 0; $i < 500; $i++) {
+                    $needles[] = 'term' . $i . 'x';
+                }
+
+                $buffer = new StringBuffer(str_repeat('Line with term42x and term499x' . PHP_EOL, $size));
+
+                return () ==> $buffer->replace($needles->toArray(), '***');
+            });
+
+            $suite->add('StringBuffer', 'replaceAll 500 needles', $size, () ==> {
+                $needles = Vector {};
+
+                for ($i = 0; $i < 500; $i++) {
+                    $needles[] = 'term' . $i . 'x';
+                }
+
+                $buffer = new StringBuffer(str_repeat('Line with term42x and term499x' . PHP_EOL, $size));
+                $matcher = StringBuffer::compileNeedles($needles);
+
+                return () ==> $buffer->replaceAll($matcher, '***');
+            });
+        }
+    }
+
+}
@@ -0,0 +1,268 @@
+<?hh
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Bench;
+
+/**
+ * The Suite registers benchmark cases, runs them, and reports the operations per second,
+ * memory retained per operation, and memory usage for each case and collection size.
+ *
+ * Since the peak memory of a process can not be reset, each case should be run in its own process
+ * for the peak to belong to that case. When a command is defined with `isolate()`, the suite re-invokes
+ * the command for every case with a `--case=<index> --json` argument, and the command is expected to
+ * run only that case using `only()`.
+ *
+ * @package Titon\Type\Bench
+ */
+class Suite {
+
+    /**
+     * Registered cases. Each case is a factory that prepares fixtures and returns the operation to measure.
+     *
+     * @var Vector<Pair<Map<string, mixed>, (function(): (function(): mixed))>>
+     */
+    protected Vector<Pair<Map<string, mixed>, (function(): (function(): mixed))>> $cases = Vector {};
+
+    /**
+     * Command that runs a single case in a separate process. Cases are run in this process when empty.
+     *
+     * @var string
+     */
+    protected string $command = '';
+
+    /**
+     * Only run cases whose name contains this string.
+     *
+     * @var string
+     */
+    protected string $filter;
+
+    /**
+     * Maximum amount of iterations per case.
+     *
+     * @var int
+     */
+    protected int $maxIterations;
+
+    /**
+     * Minimum amount of seconds to run each case for.
+     *
+     * @var float
+     */
+    protected float $minTime;
+
+    /**
+     * Only run the case at this index, or all cases if negative.
+     *
+     * @var int
+     */
+    protected int $only = -1;
+
+    /**
+     * Measurements for every case that was run.
+     *
+     * @var Vector<Map<string, mixed>>
+     */
+    protected Vector<Map<string, mixed>> $results = Vector {};
+
+    /**
+     * Set the run settings.
+     *
+     * @param string $filter
+     * @param float $minTime
+     * @param int $maxIterations
+     */
+    public function __construct(string $filter = '', float $minTime = 0.5, int $maxIterations = 100000) {
+        $this->filter = $filter;
+        $this->minTime = $minTime;
+        $this->maxIterations = $maxIterations;
+    }
+
+    /**
+     * Register a case. The factory is called once before measuring, so that fixture setup is excluded,
+     * and must return the operation to be measured.
+     *
+     * @param string $group
+     * @param string $name
+     * @param int $size
+     * @param (function(): (function(): mixed)) $factory
+     * @return $this
+     */
+    public function add(string $group, string $name, int $size, (function(): (function(): mixed)) $factory): this {
+        $this->cases[] = Pair {Map {'group' => $group, 'name' => $name, 'size' => $size}, $factory};
+
+        return $this;
+    }
+
+    /**
+     * Return all measurements.
+     *
+     * @return Vector<Map<string, mixed>>
+     */
+    public function getResults(): Vector<Map<string, mixed>> {
+        return $this->results;
+    }
+
+    /**
+     * Run each case in a separate process by appending `--case=<index> --json` to the command.
+     * The command must register the same cases in the same order.
+     *
+     * @param string $command
+     * @return $this
+     */
+    public function isolate(string $command): this {
+        $this->command = $command;
+
+        return $this;
+    }
+
+    /**
+     * Only run the case at the index.
+     *
+     * @param int $index
+     * @return $this
+     */
+    public function only(int $index): this {
+        $this->only = $index;
+
+        return $this;
+    }
+
+    /**
+     * Run every registered case that matches the filter.
+     *
+     * @return $this
+     */
+    public function run(): this {
+        foreach ($this->cases as $index => $case) {
+            list($info, $factory) = $case;
+            $label = $info['group'] . '::' . $info['name'];
+
+            if (($this->only >= 0 && $index !== $this->only) || ($this->filter !== '' && strpos($label, $this->filter) === false)) {
+                continue;
+            }
+
+            if ($this->command !== '') {
+                $this->results[] = $info->toMap()->setAll($this->spawn($index));
+            } else {
+                $this->results[] = $info->toMap()->setAll($this->measure($factory));
+            }
+        }
+
+        return $this;
+    }
+
+    /**
+     * Return the measurements as a JSON document, which can be stored and compared between releases.
+     *
+     * @return string
+     */
+    public function toJson(): string {
+        $results = [];
+
+        foreach ($this->results as $result) {
+            $results[] = $result->toArray();
+        }
+
+        return json_encode([
+            'hhvm' => defined('HHVM_VERSION') ? constant('HHVM_VERSION') : PHP_VERSION,
+            'time' => date(DATE_ATOM),
+            'results' => $results
+        ], JSON_PRETTY_PRINT);
+    }
+
+    /**
+     * Return the measurements as a plain text table.
+     *
+     * @return string
+     */
+    public function toTable(): string {
+        $output = sprintf("%-50s %10s %10s %14s %14s %12s %12s", 'Case', 'Size', 'Iterations', 'Ops/sec', 'Retained/op', 'Setup MB', 'Peak MB') . PHP_EOL;
+        $output .= str_repeat('-', 128) . PHP_EOL;
+
+        foreach ($this->results as $result) {
+            $output .= sprintf("%-50s %10d %10d %14.2f %14d %12.2f %12.2f",
+                $result['group'] . '::' . $result['name'],
+                $result['size'],
+                $result['iterations'],
+                $result['opsPerSec'],
+                $result['retainedPerOp'],
+                $result['setupMemory'] / 1048576,
+                $result['peakMemory'] / 1048576
+            ) . PHP_EOL;
+        }
+
+        return $output;
+    }
+
+    /**
+     * Prepare the fixtures for a case and measure its operation until either the minimum time
+     * or the maximum amount of iterations has been reached.
+     *
+     * The retained memory per operation is the memory still held by the operation's result, and does not
+     * include memory that was allocated and freed during the operation. The setup memory is the memory in use
+     * once the fixtures are prepared, and the peak memory is the peak of the whole process. When the case runs
+     * in its own process, the peak minus the setup memory is the most memory the operation allocated at once,
+     * including temporary copies.
+     *
+     * @param (function(): (function(): mixed)) $factory
+     * @return Map<string, mixed>
+     */
+    protected function measure((function(): (function(): mixed)) $factory): Map<string, mixed> {
+        $operation = $factory();
+        $setup = memory_get_usage();
+
+        // Warm up the JIT before measuring
+        $operation();
+
+        gc_collect_cycles();
+
+        $iterations = 0;
+        $retained = 0;
+        $elapsed = 0.0;
+
+        do {
+            $memory = memory_get_usage();
+            $start = microtime(true);
+
+            $result = $operation();
+
+            $elapsed += microtime(true) - $start;
+            $retained += memory_get_usage() - $memory;
+            $iterations++;
+
+            unset($result);
+        } while ($elapsed < $this->minTime && $iterations < $this->maxIterations);
+
+        return Map {
+            'iterations' => $iterations,
+            'opsPerSec' => ($elapsed > 0) ? ($iterations / $elapsed) : 0.0,
+            'retainedPerOp' => (int) max(0, $retained / $iterations),
+            'setupMemory' => $setup,
+            'peakMemory' => memory_get_peak_usage()
+        };
+    }
+
+    /**
+     * Run the case at the index in a separate process and return its measurements.
+     *
+     * @param int $index
+     * @return Map<string, mixed>
+     * @throws \RuntimeException
+     */
+    protected function spawn(int $index): Map<string, mixed> {
+        $output = shell_exec($this->command . ' --case=' . $index . ' --json');
+        $data = json_decode((string) $output, true);
+
+        if (!is_array($data) || empty($data['results'][0])) {
+            throw new \RuntimeException(sprintf('Case %s failed to run in a separate process', $index));
+        }
+
+        return new Map($data['results'][0]);
+    }
+
+}
@@ -0,0 +1,57 @@
+<?hh
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+namespace Titon\Type\Bench;
+
+use Titon\Type\Xml;
+
+/**
+ * Benchmark cases for parsing, serializing, and converting XML documents.
+ *
+ * @package Titon\Type\Bench
+ */
+class XmlCases {
+
+    /**
+     * Register all XML cases for every document size. The size is the document length in bytes.
+     *
+     * @param \Titon\Type\Bench\Suite $suite
+     * @param Vector<int> $sizes
+     */
+    public static function register(Suite $suite, Vector<int> $sizes): void {
+        foreach ($sizes as $size) {
+            $suite->add('Xml', 'fromString', $size, () ==> {
+                $xml = Fixture::xml($size);
+
+                return () ==> Xml::fromString($xml);
+            });
+
+            $suite->add('Xml', 'Element::toString', $size, () ==> {
+                $element = Xml::fromString(Fixture::xml($size));
+
+                return () ==> $element->toString();
+            });
+
+            $suite->add('Xml', 'Element::toMap', $size, () ==> {
+                $element = Xml::fromString(Fixture::xml($size));
+
+                return () ==> $element->toMap();
+            });
+
+            $suite->add('Xml', 'Element::toLazyMap (first key)', $size, () ==> {
+                $element = Xml::fromString(Fixture::xml($size));
+
+                return () ==> {
+                    $map = $element->toLazyMap(false);
+
+                    return $map->get($map->keys()[0]);
+                };
+            });
+        }
+    }
+
+}
@@ -0,0 +1,74 @@
+<?hh
+/**
+ * @copyright   2010-2015, The Titon Project
+ * @license     http://opensource.org/licenses/bsd-license.php
+ * @link        http://titon.io
+ */
+
+/**
+ * --------------------------------------------------------------
+ *  Benchmark Runner
+ * --------------------------------------------------------------
+ *
+ * Runs the benchmark suite and prints a table (or JSON with --json) of the results.
+ *
+ *  --filter=<string>   Only run cases whose name contains the string
+ *  --sizes=<list>      Comma separated collection sizes (default 1000,10000,100000)
+ *  --time=<seconds>    Minimum time to run each case for (default 0.5)
+ *  --large             Include the 100MB XML document
+ *  --json              Output JSON instead of a table
+ *  --inline            Run all cases in this process, which makes the peak memory cumulative
+ *  --case=<index>      Only run the case at the index in this process (used for isolation)
+ */
+
+require_once __DIR__ . '/../vendor/autoload.php';
+
+use Titon\Type\Bench\CollectionCases;
+use Titon\Type\Bench\SerializationCases;
+use Titon\Type\Bench\StringCases;
+use Titon\Type\Bench\Suite;
+use Titon\Type\Bench\XmlCases;
+
+$options = getopt('', ['filter:', 'sizes:', 'time:', 'large', 'json', 'inline', 'case:']);
+
+$sizes = new Vector(array_map('intval', explode(',', isset($options['sizes']) ? $options['sizes'] : '1000,10000,100000')));
+$documents = Vector {1024, 1048576};
+
+if (isset($options['large'])) {
+    $documents[] = 104857600;
+}
+
+$suite = new Suite(
+    isset($options['filter']) ? (string) $options['filter'] : '',
+    isset($options['time']) ? (float) $options['time'] : 0.5
+);
+
+CollectionCases::register($suite, $sizes);
+StringCases::register($suite, $sizes);
+XmlCases::register($suite, $documents);
+SerializationCases::register($suite, $sizes, $documents);
+
+if (isset($options['case'])) {
+    $suite->only((int) $options['case']);
+
+} else if (!isset($options['inline'])) {
+    // Child processes must register the same cases, so pass through the options that define them
+    $command = escapeshellarg(PHP_BINARY) . ' ' . escapeshellarg(__FILE__);
+
+    foreach (['sizes', 'time'] as $option) {
+        if (isset($options[$option])) {
+            $command .= ' --' . $option . '=' . escapeshellarg((string) $options[$option]);
+        }
+    }
+
+    if (isset($options['large'])) {
+        $command .= ' --large';
+    }
+
+    $suite->isolate($command);
+}
+
+$suite->run();
+
+echo isset($options['json']) ? $suite->toJson() : $suite->toTable();
+echo PHP_EOL;
@@ -13,9 +13,15 @@
  * Defines type aliases that are used by the type package.
  */
 
+namespace Titon\Type {
+    type ProfileEntry = shape('class' => string, 'method' => string, 'calls' => int, 'elements' => int, 'bytes' => int, 'callbacks' => int, 'time' => float);
+}
+
 namespace Titon\Type\Xml {
     type AttributeMap = Map<string, string>;
     type ElementList = Vector<Element>;
     type NamespaceMap = Map<string, string>;
+    type QueryPredicate = shape('type' => int, 'key' => string, 'value' => string);
+    type QueryStep = shape('descendant' => bool, 'name' => string, 'predicates' => Vector<QueryPredicate>);
     type XmlMap = Map<string, mixed>;
 }